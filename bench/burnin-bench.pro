@@ -0,0 +1,29 @@
+# Measures how fast the devices are polled, usually with simulated devices
+
+QT       += core network
+QT       -= gui
+
+TARGET = burnin-bench
+TEMPLATE = app
+
+# Next to burnin in the top build directory
+DESTDIR = $$OUT_PWD/..
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+CONFIG += c++11
+QMAKE_CXXFLAGS += -Werror=switch
+
+OBJECTS_DIR = obj
+MOC_DIR = obj
+
+include(../core.pri)
+
+SOURCES += \
+    main.cpp \
+    latencystats.cpp
+
+HEADERS += \
+    latencystats.h
@@ -0,0 +1,67 @@
+#include "latencystats.h"
+
+#include <QJsonArray>
+
+#include <algorithm>
+#include <cmath>
+
+void LatencyStats::add(qint64 value) {
+    _values.push_back(value);
+    _sorted = false;
+}
+
+size_t LatencyStats::getCount() const {
+    return _values.size();
+}
+
+qint64 LatencyStats::getPercentile(double p) const {
+    if (_values.empty())
+        return 0;
+    if (not _sorted) {
+        std::sort(_values.begin(), _values.end());
+        _sorted = true;
+    }
+    // Nearest rank
+    size_t rank = static_cast<size_t>(std::ceil(p / 100 * _values.size()));
+    return _values[rank > 0 ? rank - 1 : 0];
+}
+
+qint64 LatencyStats::getMax() const {
+    return getPercentile(100);
+}
+
+double LatencyStats::getMean() const {
+    if (_values.empty())
+        return 0;
+    double sum = 0;
+    for (qint64 value: _values)
+        sum += value;
+    return sum / _values.size();
+}
+
+QJsonObject LatencyStats::toJson() const {
+    std::vector<qint64> buckets;
+    for (qint64 value: _values) {
+        size_t bucket = 0;
+        while (value > 0) {
+            value >>= 1;
+            ++bucket;
+        }
+        if (buckets.size() <= bucket)
+            buckets.resize(bucket + 1, 0);
+        ++buckets[bucket];
+    }
+    QJsonArray histogram;
+    for (qint64 count: buckets)
+        histogram.append(count);
+
+    QJsonObject json;
+    json["count"] = static_cast<qint64>(_values.size());
+    json["mean_us"] = getMean();
+    json["p50_us"] = getPercentile(50);
+    json["p90_us"] = getPercentile(90);
+    json["p99_us"] = getPercentile(99);
+    json["max_us"] = getMax();
+    json["histogram"] = histogram;
+    return json;
+}
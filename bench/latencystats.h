@@ -0,0 +1,45 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <QJsonObject>
+#include <QtGlobal>
+
+#include <vector>
+
+/**
+ * Collects measured times and summarizes them by percentiles and a
+ * histogram with power of two buckets. Not thread-safe.
+ */
+class LatencyStats
+{
+public:
+    /**
+     * @param value Measured time in µs
+     */
+    void add(qint64 value);
+
+    size_t getCount() const;
+
+    /**
+     * @param p Percentile between 0 and 100
+     * @return The value below which p percent of the values are, 0 if
+     *     there are none
+     */
+    qint64 getPercentile(double p) const;
+    qint64 getMax() const;
+    double getMean() const;
+
+    /**
+     * @return Count, mean, p50, p90, p99 and max in µs and the
+     *     histogram. Bucket n of the histogram counts the values from
+     *     2^(n-1) to 2^n - 1 µs, bucket 0 those of at most 0 µs.
+     */
+    QJsonObject toJson() const;
+
+private:
+    // Sorted when a percentile is taken
+    mutable std::vector<qint64> _values;
+    mutable bool _sorted = true;
+};
+
+#endif // LATENCYSTATS_H
@@ -0,0 +1,299 @@
+#include "general/logger.h"
+#include "general/BurnInException.h"
+#include "general/hwdescriptionparser.h"
+#include "general/systemcontrollerclass.h"
+#include "general/commandprogram.h"
+#include "general/commandexecuter.h"
+#include "general/pollscheduler.h"
+#include "general/devicepoller.h"
+#include "general/samplehub.h"
+#include "devices/environment/thermorasp.h"
+#include "bench/latencystats.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+extern "C" {
+	#include "lxi.h"
+}
+#include <chrono>
+#include <cstdio>
+#include <map>
+
+const int GUI_UPDATE_INTERVAL = 100; // ms, like the readings cache of the GUI
+const size_t GUI_BATCH_SIZE = 1024;
+
+Logger logger(true, true);
+bool verbose = false;
+
+void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg) {
+    if (type == QtDebugMsg and not verbose)
+        return;
+    logger.handleMessage(type, context, msg);
+}
+
+struct PollerStats {
+    std::string name;
+    unsigned long triggers = 0;
+    unsigned long skipped = 0;
+    LatencyStats lateness; // Trigger after the deadline
+    LatencyStats waited; // Trigger until the poll started
+    LatencyStats duration; // Of the poll
+};
+
+// Every simulated device is set up copies times
+std::vector<InstrumentDescription> replicate(const std::vector<InstrumentDescription>& descs, int copies) {
+    std::vector<InstrumentDescription> result;
+    for (const auto& desc: descs) {
+        bool simulated = desc.attrs.count("simulate") != 0 and desc.attrs.at("simulate") == "true";
+        if (not simulated and copies > 1 and desc.type != "Recorder")
+            qWarning("%s is not simulated and is used only once", desc.attrs.at("class").c_str());
+        int n = simulated ? copies : 1;
+        for (int i = 0; i < n; ++i)
+            result.push_back(desc);
+    }
+    return result;
+}
+
+void printStats(FILE* out, const char* name, const LatencyStats& stats) {
+    fprintf(out, "  %-18s n=%-7zu p50=%-8lld p99=%-8lld max=%lld µs\n", name, stats.getCount(),
+        stats.getPercentile(50), stats.getPercentile(99), stats.getMax());
+}
+
+int main(int argc, char *argv[]) {
+    //replaces commas with dots in printf
+    setlocale(LC_ALL,"");
+    setlocale(LC_NUMERIC,"");
+    qRegisterMetaType<ThermoraspReadings>("ThermoraspReadings");
+    qRegisterMetaType<QtMsgType>("QtMsgType");
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("burnin-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the latencies of polling the devices, usually simulated ones");
+    parser.addHelpOption();
+    parser.addPositionalArgument("hardware", "Hardware description file (XML)");
+    QCommandLineOption durationOption({"d", "duration"}, "Poll for <seconds> (default 60). Ignored if commands are run.", "seconds", "60");
+    QCommandLineOption copiesOption({"n", "copies"}, "Set up every simulated device <n> times.", "n", "1");
+    QCommandLineOption commandsOption({"c", "commands"}, "Run the commands in <file> and time them.", "file");
+    QCommandLineOption jsonOption({"j", "json"}, "Write the results as JSON to <file>, - for stdout.", "file");
+    QCommandLineOption logOption({"l", "log"}, "Append the log to <file>.", "file");
+    QCommandLineOption verboseOption({"v", "verbose"}, "Also log debug messages.");
+    parser.addOption(durationOption);
+    parser.addOption(copiesOption);
+    parser.addOption(commandsOption);
+    parser.addOption(jsonOption);
+    parser.addOption(logOption);
+    parser.addOption(verboseOption);
+    parser.process(app);
+
+    QStringList args = parser.positionalArguments();
+    if (args.size() != 1)
+        parser.showHelp(1);
+    bool ok;
+    int duration = parser.value(durationOption).toInt(&ok);
+    if (not ok or duration <= 0) {
+        fprintf(stderr, "Invalid duration %s\n", parser.value(durationOption).toLocal8Bit().constData());
+        return 1;
+    }
+    int copies = parser.value(copiesOption).toInt(&ok);
+    if (not ok or copies <= 0) {
+        fprintf(stderr, "Invalid number of copies %s\n", parser.value(copiesOption).toLocal8Bit().constData());
+        return 1;
+    }
+    verbose = parser.isSet(verboseOption);
+    if (parser.isSet(logOption) and not logger.setLogFile(parser.value(logOption))) {
+        fprintf(stderr, "Could not open log file %s\n", parser.value(logOption).toLocal8Bit().constData());
+        return 1;
+    }
+
+    lxi_init();
+    qInstallMessageHandler(messageHandler);
+
+    // Filled on the threads of the scheduler and the pollers. Declared
+    // before the controller, which waits for running polls when deleted
+    QMutex statsMutex;
+    std::map<DevicePoller*, PollerStats> pollerStats;
+
+    SystemControllerClass controller;
+    CommandProgram program;
+    try {
+        HWDescriptionParser hwParser;
+        controller.setupFromDesc(replicate(hwParser.ParseXML(args[0]), copies));
+        for (auto& daq: controller.getDaqModules())
+            daq->setUseTerminal(false);
+
+        if (parser.isSet(commandsOption)) {
+            QElapsedTimer compileClock;
+            compileClock.start();
+            program = CommandProgram::compileFile(parser.value(commandsOption), &controller);
+            qInfo("Compiled the commands in %lld ms", compileClock.elapsed());
+        }
+
+        controller.initialize();
+    } catch (const BurnInException& e) {
+        qCritical("%s", e.what());
+        return 1;
+    }
+
+    PollScheduler* scheduler = controller.getScheduler();
+    for (const auto& poller: scheduler->getPollers()) {
+        pollerStats[poller].name = poller->getName();
+        QObject::connect(poller, &DevicePoller::pollFinished, [&statsMutex, &pollerStats, poller](qint64 waited, qint64 duration) {
+            QMutexLocker locker(&statsMutex);
+            pollerStats[poller].waited.add(waited);
+            pollerStats[poller].duration.add(duration);
+        });
+    }
+    QObject::connect(scheduler, &PollScheduler::pollerTriggered, [&statsMutex, &pollerStats](DevicePoller* poller, qint64 lateness, bool skipped) {
+        QMutexLocker locker(&statsMutex);
+        PollerStats& stats = pollerStats[poller];
+        ++stats.triggers;
+        if (skipped)
+            ++stats.skipped;
+        stats.lateness.add(lateness);
+    });
+
+    // Time from publishing a reading until the GUI would display it
+    SampleHub* hub = controller.getSampleHub();
+    int consumer = hub->addConsumer();
+    std::vector<Sample> samples(GUI_BATCH_SIZE);
+    LatencyStats guiLatency;
+    QTimer guiTimer;
+    QObject::connect(&guiTimer, &QTimer::timeout, [&]() {
+        qint64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        size_t count;
+        while ((count = hub->drain(consumer, samples.data(), samples.size())) > 0) {
+            for (size_t i = 0; i < count; ++i)
+                guiLatency.add((now - samples[i].time) / 1000);
+        }
+    });
+
+    // Filled on the thread of the executer
+    int commandCount = program.getCommandCount();
+    std::vector<qint64> commandDurations(commandCount, -1); // ms
+    QElapsedTimer commandClock;
+    CommandExecuter executer(program, &controller);
+    QThread executerThread;
+    executer.moveToThread(&executerThread);
+    QObject::connect(&executerThread, &QThread::started, &executer, &CommandExecuter::start);
+    QObject::connect(&executer, &CommandExecuter::commandStarted, [&commandClock](int, QDateTime) {
+        commandClock.start();
+    });
+    QObject::connect(&executer, &CommandExecuter::commandFinished, [&commandClock, &commandDurations](int n, QDateTime) {
+        commandDurations[n] = commandClock.elapsed();
+    });
+    QObject::connect(&executer, &CommandExecuter::allFinished, &app, &QCoreApplication::quit);
+
+    QElapsedTimer clock;
+    clock.start();
+    controller.startRefreshingReadings();
+    guiTimer.start(GUI_UPDATE_INTERVAL);
+    if (commandCount == 0)
+        QTimer::singleShot(duration * 1000, &app, &QCoreApplication::quit);
+    else
+        executerThread.start();
+    app.exec();
+    double elapsed = clock.elapsed() / 1000.;
+    guiTimer.stop();
+    executerThread.quit();
+    executerThread.wait();
+
+    // The summary goes to stderr if stdout gets the JSON
+    bool jsonToStdout = parser.isSet(jsonOption) and parser.value(jsonOption) == "-";
+    FILE* out = jsonToStdout ? stderr : stdout;
+
+    QMutexLocker locker(&statsMutex);
+    QJsonArray devicesJson;
+    fprintf(out, "Polled for %.1f s\n", elapsed);
+    for (const auto& entry: pollerStats) {
+        const PollerStats& stats = entry.second;
+        QJsonObject device;
+        device["name"] = QString::fromStdString(stats.name);
+        device["triggers"] = static_cast<qint64>(stats.triggers);
+        device["overruns"] = static_cast<qint64>(stats.skipped);
+        device["lateness"] = stats.lateness.toJson();
+        device["wait"] = stats.waited.toJson();
+        device["poll"] = stats.duration.toJson();
+        devicesJson.append(device);
+
+        fprintf(out, "%s: %lu triggers, %lu overruns\n", stats.name.c_str(), stats.triggers, stats.skipped);
+        printStats(out, "poll", stats.duration);
+        printStats(out, "wait for thread", stats.waited);
+        printStats(out, "trigger lateness", stats.lateness);
+    }
+    fprintf(out, "Readings\n");
+    printStats(out, "publish to GUI", guiLatency);
+    fprintf(out, "  dropped: %lu\n", hub->getDroppedCount());
+
+    QJsonArray communicationJson;
+    for (const auto& device: controller.getDevices()) {
+        CommunicationStats stats = device->getStats();
+        QJsonObject comm;
+        comm["name"] = QString::fromStdString(controller.getId(device));
+        comm["bytes_sent"] = static_cast<qint64>(stats.bytesSent);
+        comm["bytes_received"] = static_cast<qint64>(stats.bytesReceived);
+        comm["queries"] = static_cast<qint64>(stats.queries);
+        comm["round_trip_total_us"] = stats.roundTripTotal;
+        comm["round_trip_max_us"] = stats.roundTripMax;
+        comm["timeouts"] = static_cast<qint64>(stats.timeouts);
+        comm["lock_contentions"] = static_cast<qint64>(stats.lockContentions);
+        comm["lock_wait_total_us"] = stats.lockWaitTotal;
+        comm["lock_wait_max_us"] = stats.lockWaitMax;
+        communicationJson.append(comm);
+    }
+
+    QJsonArray commandsJson;
+    for (int n = 0; n < commandCount; ++n) {
+        QJsonObject command;
+        command["index"] = n;
+        command["duration_ms"] = commandDurations[n];
+        commandsJson.append(command);
+        if (commandDurations[n] >= 0)
+            fprintf(out, "Command %d took %lld ms\n", n + 1, commandDurations[n]);
+        else
+            fprintf(out, "Command %d did not finish\n", n + 1);
+    }
+
+    QJsonObject result;
+    result["hardware"] = args[0];
+    result["copies"] = copies;
+    result["duration_s"] = elapsed;
+    result["devices"] = devicesJson;
+    result["communication"] = communicationJson;
+    result["gui_latency"] = guiLatency.toJson();
+    result["dropped_samples"] = static_cast<qint64>(hub->getDroppedCount());
+    result["commands"] = commandsJson;
+    result["estimated_duration_s"] = program.getEstimatedDuration();
+    result["command_error"] = executer.hadError();
+
+    int status = 0;
+    if (parser.isSet(jsonOption)) {
+        QFile file;
+        if (jsonToStdout)
+            file.open(stdout, QIODevice::WriteOnly);
+        else
+            file.setFileName(parser.value(jsonOption));
+        if ((file.isOpen() or file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                and file.write(QJsonDocument(result).toJson()) != -1) {
+            file.close();
+        } else {
+            fprintf(stderr, "Could not write %s\n", parser.value(jsonOption).toLocal8Bit().constData());
+            status = 1;
+        }
+    }
+
+    if (executer.hadError())
+        status = 1;
+    return status;
+}
@@ -0,0 +1,25 @@
+# Runs a command list without a GUI, e.g. on a headless machine
+
+QT       += core network
+QT       -= gui
+
+TARGET = burnin-cli
+TEMPLATE = app
+
+# Next to burnin in the top build directory
+DESTDIR = $$OUT_PWD/..
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+CONFIG += c++11
+QMAKE_CXXFLAGS += -Werror=switch
+
+OBJECTS_DIR = obj
+MOC_DIR = obj
+
+include(../core.pri)
+
+SOURCES += \
+    main.cpp
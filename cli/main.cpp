@@ -0,0 +1,137 @@
+#include "general/logger.h"
+#include "general/BurnInException.h"
+#include "general/hwdescriptionparser.h"
+#include "general/systemcontrollerclass.h"
+#include "general/commandprogram.h"
+#include "general/commandsimulator.h"
+#include "general/commandexecuter.h"
+#include "devices/environment/thermorasp.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QThread>
+extern "C" {
+	#include "lxi.h"
+}
+#include <cmath>
+#include <cstdio>
+
+Logger logger(true, true);
+bool verbose = false;
+
+QString formatTime(double seconds) {
+    qint64 s = std::llround(seconds);
+    return QString("%1:%2:%3").arg(s / 3600).arg(s / 60 % 60, 2, 10, QChar('0')).arg(s % 60, 2, 10, QChar('0'));
+}
+
+// Prints the projected timeline of a run instead of running it
+void printDryRun(const CommandProgram& program, const SystemControllerClass& controller) {
+    SimulationResult result = CommandSimulator(program, &controller).run();
+    for (const auto& entry: result.timeline) {
+        printf("%10s  Command %d: %s", formatTime(entry.start).toLocal8Bit().constData(),
+            entry.command + 1, entry.description.toLocal8Bit().constData());
+        if (entry.highVoltage != 0)
+            printf(", HV %.0f V", entry.highVoltage);
+        if (not std::isnan(entry.temperature))
+            printf(", bath %.1f °C", entry.temperature);
+        printf("\n");
+    }
+    printf("Duration: %s\n", formatTime(result.duration).toLocal8Bit().constData());
+    printf("Peak high voltage: %.0f V\n", result.peakHighVoltage);
+    if (not std::isnan(result.minTemperature))
+        printf("Bath temperature: %.1f to %.1f °C\n", result.minTemperature, result.maxTemperature);
+    if (result.daqCommands > 0)
+        printf("Not included: %d DAQ commands\n", result.daqCommands);
+}
+
+void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg) {
+    if (type == QtDebugMsg and not verbose)
+        return;
+    logger.handleMessage(type, context, msg);
+}
+
+int main(int argc, char *argv[]) {
+    //replaces commas with dots in printf
+    setlocale(LC_ALL,"");
+    setlocale(LC_NUMERIC,"");
+    qRegisterMetaType<ThermoraspReadings>("ThermoraspReadings");
+    qRegisterMetaType<QtMsgType>("QtMsgType");
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("burnin-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs a list of burn-in commands without a GUI");
+    parser.addHelpOption();
+    parser.addPositionalArgument("hardware", "Hardware description file (XML)");
+    parser.addPositionalArgument("commands", "File with the commands to run");
+    QCommandLineOption logOption({"l", "log"}, "Append the log to <file>.", "file");
+    QCommandLineOption verboseOption({"v", "verbose"}, "Also log debug messages.");
+    QCommandLineOption dryRunOption({"n", "dry-run"}, "Print how the run would go without connecting to the devices.");
+    parser.addOption(logOption);
+    parser.addOption(verboseOption);
+    parser.addOption(dryRunOption);
+    parser.process(app);
+
+    QStringList args = parser.positionalArguments();
+    if (args.size() != 2)
+        parser.showHelp(1);
+    verbose = parser.isSet(verboseOption);
+    if (parser.isSet(logOption) and not logger.setLogFile(parser.value(logOption))) {
+        fprintf(stderr, "Could not open log file %s\n", parser.value(logOption).toLocal8Bit().constData());
+        return 1;
+    }
+
+    lxi_init();
+    qInstallMessageHandler(messageHandler);
+
+    SystemControllerClass controller;
+    CommandProgram program;
+    try {
+        HWDescriptionParser hwParser;
+        controller.setupFromDesc(hwParser.ParseXML(args[0]));
+        for (auto& daq: controller.getDaqModules())
+            daq->setUseTerminal(false);
+
+        program = CommandProgram::compileFile(args[1], &controller);
+        if (parser.isSet(dryRunOption)) {
+            printDryRun(program, controller);
+            return 0;
+        }
+
+        controller.initialize();
+        // Fails if the commands use a device that couldn't be initialized
+        if (not controller.getFailedDevices().empty())
+            program = CommandProgram::compileFile(args[1], &controller);
+        controller.startRefreshingReadings();
+    } catch (const BurnInException& e) {
+        qCritical("%s", e.what());
+        return 1;
+    }
+
+    qInfo("Estimated duration: %.0f s", program.getEstimatedDuration());
+    int commandCount = program.getCommandCount();
+    CommandExecuter executer(program, &controller);
+    QThread thread;
+    executer.moveToThread(&thread);
+    QObject::connect(&thread, &QThread::started, &executer, &CommandExecuter::start);
+    QObject::connect(&executer, &CommandExecuter::commandStarted, &app, [commandCount](int n, QDateTime dt) {
+        qInfo("[%s] Command %d of %d started", dt.toString("hh:mm:ss").toLatin1().data(), n + 1, commandCount);
+    });
+    QObject::connect(&executer, &CommandExecuter::commandStatusUpdate, &app, [](int n, QString status) {
+        qInfo("Command %d: %s", n + 1, status.toLocal8Bit().constData());
+    });
+    QObject::connect(&executer, &CommandExecuter::allFinished, &app, &QCoreApplication::quit);
+
+    thread.start();
+    app.exec();
+    thread.quit();
+    thread.wait();
+
+    if (executer.hadError()) {
+        qCritical("Stopped because a command failed");
+        return 1;
+    }
+    qInfo("All commands finished");
+    return 0;
+}
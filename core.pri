@@ -0,0 +1,11 @@
+# Link against the core library built by core/core.pro. Included by the
+# projects of the programs.
+
+INCLUDEPATH += $$PWD
+
+CORE_BUILD_DIR = $$shadowed($$PWD)/core
+LIBS += -L$$CORE_BUILD_DIR -lburnincore
+PRE_TARGETDEPS += $$CORE_BUILD_DIR/libburnincore.a
+
+#unix:
+LIBS += -L/usr/local/lib/ -llxi
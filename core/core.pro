@@ -0,0 +1,91 @@
+# Devices, command processing and everything else not depending on the
+# GUI. Built as a static library, which the GUI, the command line program
+# and other tools link against (see core.pri).
+
+QT       += core network
+QT       -= gui
+
+TARGET = burnincore
+TEMPLATE = lib
+CONFIG += staticlib
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+CONFIG += c++11
+QMAKE_CXXFLAGS += -Werror=switch
+
+OBJECTS_DIR = obj
+MOC_DIR = obj
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    ../general/hwdescriptionparser.cpp \
+    ../devices/environment/JulaboFP50.cpp \
+    ../devices/environment/thermorasp.cpp \
+    ../devices/genericinstrumentclass.cpp \
+    ../devices/devicecontext.cpp \
+    ../general/systemcontrollerclass.cpp \
+    ../devices/power/controlkeithleypower.cpp \
+    ../devices/power/controlttipower.cpp \
+    ../devices/power/powercontrolclass.cpp \
+    ../devices/daq/daqmodule.cpp \
+    ../general/commandprocessor.cpp \
+    ../general/commandprogram.cpp \
+    ../general/commandsimulator.cpp \
+    ../general/burnincommand.cpp \
+    ../devices/environment/chiller.cpp \
+    ../devices/environment/HuberPetiteFleur.cpp \
+    ../general/logger.cpp \
+    ../devices/power/kepco.cpp \
+    ../devices/communication/communicator.cpp \
+    ../devices/communication/lxicommunicator.cpp \
+    ../devices/communication/connectionsupervisor.cpp \
+    ../devices/changefilter.cpp \
+    ../general/devicepoller.cpp \
+    ../general/pollscheduler.cpp \
+    ../devices/communication/serialcommunicator.cpp \
+    ../general/datarecorder.cpp \
+    ../general/samplehub.cpp \
+    ../general/statetable.cpp \
+    ../general/commandexecuter.cpp \
+    ../devices/simulation/instrumentsimulator.cpp \
+    ../devices/simulation/fakeserialdevice.cpp \
+    ../devices/simulation/fakethermoraspserver.cpp \
+    ../devices/communication/mockcommunicator.cpp
+
+HEADERS += \
+    ../general/hwdescriptionparser.h \
+    ../devices/environment/thermorasp.h \
+    ../devices/genericinstrumentclass.h \
+    ../devices/devicecontext.h \
+    ../general/systemcontrollerclass.h \
+    ../devices/power/controlkeithleypower.h \
+    ../devices/power/controlttipower.h \
+    ../devices/power/powercontrolclass.h \
+    ../devices/environment/JulaboFP50.h \
+    ../devices/daq/daqmodule.h \
+    ../general/commandprocessor.h \
+    ../general/commandprogram.h \
+    ../general/commandsimulator.h \
+    ../general/burnincommand.h \
+    ../devices/environment/chiller.h \
+    ../devices/environment/HuberPetiteFleur.h \
+    ../general/logger.h \
+    ../devices/power/kepco.h \
+    ../devices/communication/communicator.h \
+    ../devices/communication/lxicommunicator.h \
+    ../devices/communication/connectionsupervisor.h \
+    ../devices/changefilter.h \
+    ../general/devicepoller.h \
+    ../general/pollscheduler.h \
+    ../devices/communication/serialcommunicator.h \
+    ../general/datarecorder.h \
+    ../general/samplequeue.h \
+    ../general/samplehub.h \
+    ../general/statetable.h \
+    ../general/commandexecuter.h \
+    ../devices/simulation/instrumentsimulator.h \
+    ../devices/simulation/fakeserialdevice.h \
+    ../devices/simulation/fakethermoraspserver.h \
+    ../devices/communication/mockcommunicator.h
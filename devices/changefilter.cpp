@@ -0,0 +1,73 @@
+#include "changefilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+ChangeFilter::ChangeFilter() {
+    _defaultDeadband = {0, 0};
+    _heartbeat = 0;
+    _clock.start();
+}
+
+void ChangeFilter::setDeadband(const std::string& quantity, double absolute, double relative) {
+    _deadbands[quantity] = {absolute, relative};
+}
+
+void ChangeFilter::setDefaultDeadband(double absolute, double relative) {
+    _defaultDeadband = {absolute, relative};
+}
+
+Deadband ChangeFilter::getDeadband(const std::string& quantity) const {
+    auto it = _deadbands.find(quantity);
+    if (it == _deadbands.end())
+        return _defaultDeadband;
+    return it->second;
+}
+
+void ChangeFilter::setHeartbeat(int interval) {
+    _heartbeat = interval;
+}
+
+int ChangeFilter::getHeartbeat() const {
+    return _heartbeat;
+}
+
+bool ChangeFilter::update(const std::string& quantity, int output, double value) {
+    Deadband deadband = getDeadband(quantity);
+    return _update(quantity, output, value, &deadband);
+}
+
+bool ChangeFilter::updateState(const std::string& quantity, int output, double value) {
+    return _update(quantity, output, value, nullptr);
+}
+
+bool ChangeFilter::_update(const std::string& quantity, int output, double value, const Deadband* deadband) {
+    qint64 now = _clock.elapsed();
+    auto key = std::make_pair(quantity, output);
+    auto it = _reported.find(key);
+    if (it == _reported.end()) {
+        _reported[key] = {value, now};
+        return true;
+    }
+    
+    Reported& last = it->second;
+    bool changed;
+    if (std::isnan(value) or std::isnan(last.value))
+        // A reading becoming invalid or valid again is always a change
+        changed = std::isnan(value) != std::isnan(last.value);
+    else if (deadband == nullptr)
+        changed = value != last.value;
+    else {
+        double limit = std::max(deadband->absolute, deadband->relative * std::abs(last.value));
+        changed = std::abs(value - last.value) > limit;
+    }
+    if (not changed and (_heartbeat == 0 or now - last.time < _heartbeat))
+        return false;
+    
+    last = {value, now};
+    return true;
+}
+
+void ChangeFilter::reset() {
+    _reported.clear();
+}
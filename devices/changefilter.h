@@ -0,0 +1,91 @@
+#ifndef CHANGEFILTER_H
+#define CHANGEFILTER_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <QElapsedTimer>
+
+// Smallest change of a reading that is reported
+struct Deadband {
+    double absolute; // In the unit of the reading
+    double relative; // Fraction of the value reported last
+};
+
+/**
+ * Decides which readings of a device are worth emitting. A reading is
+ * reported if it differs from the value reported last, not from the
+ * previous reading, by more than the deadband. So noise around a value
+ * doesn't cause a signal every poll and a slow drift still shows up once
+ * it added up (hysteresis). If the heartbeat is set, a reading is also
+ * reported when nothing was reported for that long.
+ *
+ * Channels are identified by the quantity, e.g. "voltage", and the
+ * output. The deadband is set per quantity and only applies to
+ * measurements. A change into or out of NaN is always reported. Not
+ * thread-safe, it is used on the thread of its device.
+ */
+class ChangeFilter {
+public:
+    ChangeFilter();
+    
+    /**
+     * Set the deadband of a quantity. A change needs to exceed both the
+     * absolute and the relative deadband
+     */
+    void setDeadband(const std::string& quantity, double absolute, double relative = 0);
+    
+    /**
+     * Set the deadband of the quantities without one of their own.
+     * 0 by default, so that every change is reported
+     */
+    void setDefaultDeadband(double absolute, double relative = 0);
+    
+    Deadband getDeadband(const std::string& quantity) const;
+    
+    /**
+     * @param interval Time in ms after which a reading is reported even if
+     * it didn't change, 0 to never report unchanged readings
+     */
+    void setHeartbeat(int interval);
+    int getHeartbeat() const;
+    
+    /**
+     * Check a new reading
+     * @param output Output of a voltage source, 0 for other devices
+     * @return true if it should be reported. It is then taken as the value
+     * reported last
+     */
+    bool update(const std::string& quantity, int output, double value);
+    
+    /**
+     * Check a new value of a state or setting, e.g. whether an output is
+     * on or a set temperature. Every change is reported, the deadband
+     * doesn't apply
+     * @return true if it should be reported
+     */
+    bool updateState(const std::string& quantity, int output, double value);
+    
+    /**
+     * Report the next reading of every channel, e.g. after initializing
+     * the device
+     */
+    void reset();
+    
+private:
+    struct Reported {
+        double value;
+        qint64 time; // ms on _clock
+    };
+    
+    // deadband is nullptr for states
+    bool _update(const std::string& quantity, int output, double value, const Deadband* deadband);
+    
+    std::map<std::string, Deadband> _deadbands;
+    Deadband _defaultDeadband;
+    int _heartbeat; // ms, 0 for none
+    std::map<std::pair<std::string, int>, Reported> _reported;
+    QElapsedTimer _clock;
+};
+
+#endif // CHANGEFILTER_H
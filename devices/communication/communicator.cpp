@@ -1,7 +1,12 @@
 #include "communicator.h"
 
-Communicator::Communicator() {
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include <algorithm>
 
+Communicator::Communicator() {
+    _consecutiveFailures = 0;
 }
 
 
@@ -11,3 +16,72 @@ std::string Communicator::getSuffix() const {
 void Communicator::setSuffix(const std::string& suffix) {
     _suffix = suffix;
 }
+
+std::vector<std::string> Communicator::queryBatch(const std::vector<std::string>& queries) const {
+    std::vector<std::string> answers;
+    for (const auto& q: queries)
+        answers.push_back(query(q));
+    return answers;
+}
+
+CommunicationStats Communicator::getStats() const {
+    QMutexLocker locker(&_statsMutex);
+    return _stats;
+}
+
+unsigned int Communicator::getConsecutiveFailures() const {
+    QMutexLocker locker(&_statsMutex);
+    return _consecutiveFailures;
+}
+
+void Communicator::_countSent(size_t bytes) const {
+    QMutexLocker locker(&_statsMutex);
+    _stats.bytesSent += bytes;
+}
+
+void Communicator::_countReceived(size_t bytes) const {
+    QMutexLocker locker(&_statsMutex);
+    _stats.bytesReceived += bytes;
+    if (bytes > 0)
+        _consecutiveFailures = 0;
+}
+
+void Communicator::_countQuery(qint64 roundTrip) const {
+    QMutexLocker locker(&_statsMutex);
+    ++_stats.queries;
+    _stats.roundTripTotal += roundTrip;
+    _stats.roundTripMax = std::max(_stats.roundTripMax, roundTrip);
+}
+
+void Communicator::_countTimeout() const {
+    QMutexLocker locker(&_statsMutex);
+    ++_stats.timeouts;
+    ++_consecutiveFailures;
+}
+
+void Communicator::_countFailure() const {
+    QMutexLocker locker(&_statsMutex);
+    ++_consecutiveFailures;
+}
+
+void Communicator::_countLockWait(qint64 wait) const {
+    QMutexLocker locker(&_statsMutex);
+    ++_stats.lockContentions;
+    _stats.lockWaitTotal += wait;
+    _stats.lockWaitMax = std::max(_stats.lockWaitMax, wait);
+}
+
+Communicator::StatsLocker::StatsLocker(QMutex* mutex, const Communicator* comm) {
+    _mutex = mutex;
+    // Only measure if another thread has the lock, which is rare
+    if (_mutex->tryLock())
+        return;
+    QElapsedTimer clock;
+    clock.start();
+    _mutex->lock();
+    comm->_countLockWait(clock.nsecsElapsed() / 1000);
+}
+
+Communicator::StatsLocker::~StatsLocker() {
+    _mutex->unlock();
+}
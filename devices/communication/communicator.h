@@ -2,6 +2,24 @@
 #define COMMUNICATOR_H
 
 #include <string>
+#include <vector>
+#include <QMutex>
+#include <QtGlobal>
+
+/**
+ * Counters of the communication with a device, since it was created
+ */
+struct CommunicationStats {
+    quint64 bytesSent = 0;
+    quint64 bytesReceived = 0;
+    quint64 queries = 0;
+    qint64 roundTripTotal = 0; // µs from sending a query until its answer arrived
+    qint64 roundTripMax = 0; // µs
+    quint64 timeouts = 0;
+    quint64 lockContentions = 0; // Times the connection was in use by another thread
+    qint64 lockWaitTotal = 0; // µs waited for the connection
+    qint64 lockWaitMax = 0; // µs
+};
 
 /**
  * Abstract class to communicate with devices
@@ -49,6 +67,17 @@ public:
      */
     virtual std::string query(const std::string& buf, int sleep_time = 0) const = 0;
     
+    /**
+     * Send several queries and receive the answers to all of them.
+     * Implementations may send the queries together in order to save
+     * round trips. The default implementation calls query for every
+     * element.
+     * @param queries Queries to send. No suffix is needed
+     * @return The answers in the order of the queries. Can contain less
+     * elements than queries if not all answers were received
+     */
+    virtual std::vector<std::string> queryBatch(const std::vector<std::string>& queries) const;
+    
     /**
      * Get a representation of the connection or device readable by a 
      * human (e.g. an address)
@@ -69,13 +98,54 @@ public:
      */
     void setSuffix(const std::string& suffix);
     
+    /**
+     * @return Counters of the communication so far. Can be called from
+     * any thread
+     */
+    CommunicationStats getStats() const;
+    
+    /**
+     * @return Number of transfers that failed since the last one that
+     * succeeded. Can be called from any thread
+     */
+    unsigned int getConsecutiveFailures() const;
+    
     /**
      * ms to wait for data and for the connection to open
      */
     int timeout = 1000;
+    
+    /**
+     * Locks a mutex like QMutexLocker and counts the time waited for it
+     * in the stats of a communicator
+     */
+    class StatsLocker {
+    public:
+        StatsLocker(QMutex* mutex, const Communicator* comm);
+        ~StatsLocker();
+        
+        StatsLocker(const StatsLocker& other) = delete;
+        StatsLocker& operator=(const StatsLocker& other) = delete;
+        
+    private:
+        QMutex* _mutex;
+    };
+
+protected:
+    // Update the stats. Implementations call these
+    void _countSent(size_t bytes) const;
+    void _countReceived(size_t bytes) const;
+    void _countQuery(qint64 roundTrip) const; // µs
+    void _countTimeout() const; // Also counts as failure
+    void _countFailure() const; // Transfer failed without a timeout
+    void _countLockWait(qint64 wait) const; // µs waited for a lock held by another thread
 
 private:
     std::string _suffix;
+    
+    mutable CommunicationStats _stats;
+    mutable unsigned int _consecutiveFailures; // Reset by data received
+    mutable QMutex _statsMutex;
 };
 
 #endif // COMMUNICATOR_H
@@ -0,0 +1,62 @@
+#include "connectionsupervisor.h"
+#include "general/BurnInException.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+
+ConnectionSupervisor::ConnectionSupervisor() {
+    _connected = true;
+    _backoff = 0;
+    _retryAt = 0;
+    _clock.start();
+}
+
+bool ConnectionSupervisor::isConnected() const {
+    return _connected;
+}
+
+bool ConnectionSupervisor::update(const Communicator* comm, const std::string& name) {
+    unsigned int failures = comm->getConsecutiveFailures();
+    // The device answered, so the next loss starts with a short backoff
+    // again. Right after reconnecting the failures are still counted,
+    // so the first transfer needs to succeed.
+    if (failures == 0)
+        _backoff = 0;
+    if (not _connected or failures < FAILURE_LIMIT)
+        return false;
+
+    markLost();
+    qWarning("Lost the connection to %s (%s). Reconnecting in %d ms",
+        name.c_str(), comm->getLocDisplay().c_str(), _backoff);
+    return true;
+}
+
+bool ConnectionSupervisor::tryReconnect(Communicator* comm, const std::string& name) {
+    if (_connected)
+        return false;
+    if (_clock.elapsed() < _retryAt)
+        return false;
+
+    try {
+        comm->close();
+        comm->open();
+    } catch (const BurnInException& e) {
+        markLost();
+        qDebug("Reconnecting to %s failed: %s. Retrying in %d ms", name.c_str(), e.what(), _backoff);
+        return false;
+    }
+
+    _connected = true;
+    qInfo("Reconnected to %s (%s)", name.c_str(), comm->getLocDisplay().c_str());
+    return true;
+}
+
+void ConnectionSupervisor::markLost() {
+    if (_backoff == 0)
+        _backoff = BACKOFF_MIN;
+    else
+        _backoff = std::min(_backoff * 2, BACKOFF_MAX);
+    _connected = false;
+    _retryAt = _clock.elapsed() + _backoff;
+}
@@ -0,0 +1,52 @@
+#ifndef CONNECTIONSUPERVISOR_H
+#define CONNECTIONSUPERVISOR_H
+
+#include "communicator.h"
+
+#include <string>
+#include <QElapsedTimer>
+
+/**
+ * Watches the health of the connection of a communicator. After
+ * FAILURE_LIMIT failed transfers in a row the connection counts as lost.
+ * Then it is reopened with exponential backoff instead of talking to the
+ * device. Not thread-safe, it is used on the thread of its device.
+ */
+class ConnectionSupervisor {
+public:
+    ConnectionSupervisor();
+
+    bool isConnected() const;
+
+    /**
+     * Check the communicator after the device was talked to
+     * @param name Name of the device, used for log messages
+     * @return true if the connection was found to be lost just now
+     */
+    bool update(const Communicator* comm, const std::string& name);
+
+    /**
+     * Reopen the connection if it is lost and the backoff elapsed
+     * @param name Name of the device, used for log messages
+     * @return true if the connection was opened again
+     */
+    bool tryReconnect(Communicator* comm, const std::string& name);
+
+    /**
+     * Count the connection as lost again, e.g. because the device
+     * didn't take its settings after reconnecting
+     */
+    void markLost();
+
+    static const unsigned int FAILURE_LIMIT = 3;
+    static const int BACKOFF_MIN = 1000; // ms
+    static const int BACKOFF_MAX = 60000; // ms
+
+private:
+    bool _connected;
+    int _backoff; // ms
+    qint64 _retryAt; // ms on _clock
+    QElapsedTimer _clock;
+};
+
+#endif // CONNECTIONSUPERVISOR_H
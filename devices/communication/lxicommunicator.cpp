@@ -4,6 +4,7 @@
 #include <QtGlobal>
 #include <QThread>
 #include <QMutexLocker>
+#include <QElapsedTimer>
 #include <cstring>
 
 LXICommunicator::LXICommunicator(const std::string& address, int port, bool raw) {
@@ -37,6 +38,8 @@ void LXICommunicator::open() {
 
 void LXICommunicator::close() {
     QMutexLocker locker(&_mutex);
+    if (_lxidev == LXI_ERROR)
+        return;
     lxi_disconnect(_lxidev);
     _lxidev = LXI_ERROR;
 }
@@ -46,51 +49,122 @@ bool LXICommunicator::isOpen() const {
 }
 
 void LXICommunicator::send(const std::string& buf) const {
-    Q_ASSERT_X(_lxidev != LXI_ERROR, "LXICommunicator::send", "connection must be open");
+    StatsLocker locker(&_mutex, this);
+    _send(buf);
+}
+
+std::string LXICommunicator::receive() const {
+    StatsLocker locker(&_mutex, this);
+    return _receive();
+}
+
+std::string LXICommunicator::query(const std::string& buf, int sleep_time) const {
+    // Keep the lock so that no other thread can receive our answer
+    StatsLocker locker(&_mutex, this);
+    QElapsedTimer clock;
+    clock.start();
+    _send(buf);
+    QThread::msleep(sleep_time);
+    std::string received = _receive();
+    _countQuery(clock.nsecsElapsed() / 1000);
+    return received;
+}
+
+std::vector<std::string> LXICommunicator::queryBatch(const std::vector<std::string>& queries) const {
+    std::vector<std::string> answers;
+    if (queries.empty())
+        return answers;
+    
+    std::string joined;
+    for (const auto& q: queries) {
+        if (not joined.empty())
+            joined += ";";
+        joined += q;
+    }
+    
+    StatsLocker locker(&_mutex, this);
+    QElapsedTimer clock;
+    clock.start();
+    _send(joined);
+    
+    // The answer might arrive in several parts. Receive until it is
+    // terminated by a line feed or nothing more arrives.
+    std::string received;
+    do {
+        std::string part = _receive();
+        if (part.empty())
+            break;
+        received += part;
+    } while (received.back() != '\n');
+    _countQuery(clock.nsecsElapsed() / 1000);
+    if (received.empty()) {
+        qCritical("Got no answer from LXI connection %s %i", _address.c_str(), _port);
+        return answers;
+    }
+    
+    size_t start = 0;
+    while (start <= received.length()) {
+        size_t end = received.find(';', start);
+        if (end == std::string::npos)
+            end = received.length();
+        std::string answer = received.substr(start, end - start);
+        while (not answer.empty() and (answer.back() == '\n' or answer.back() == '\r'))
+            answer.pop_back();
+        answers.push_back(answer);
+        start = end + 1;
+    }
+    if (answers.size() != queries.size())
+        qCritical("Got %zu instead of %zu answers from LXI connection %s %i", answers.size(), queries.size(), _address.c_str(), _port);
+    
+    return answers;
+}
+
+std::string LXICommunicator::getLocDisplay() const {
+    std::string ret = "LXI ";
+    ret += _address;
+    ret += " ";
+    ret += _port;
+    return ret;
+}
+
+void LXICommunicator::_send(const std::string& buf) const {
+    // Closed if reconnecting after the connection was lost failed
+    if (_lxidev == LXI_ERROR) {
+        _countFailure();
+        throw BurnInException("LXI connection " + _address + " is not open");
+    }
     char* cstr = _get_cstr_copy(buf + getSuffix());
     size_t len = buf.length() + getSuffix().length();
-    QMutexLocker locker(&_mutex);
     qDebug("Send to %s %i: %s", _address.c_str(), _port, cstr);
     if (lxi_send(_lxidev, cstr, len, timeout) == LXI_ERROR) {
         delete[] cstr;
+        _countFailure();
         throw(BurnInException("Error while sending through LXI connection"));
     }
     delete[] cstr;
+    _countSent(len);
 }
 
-std::string LXICommunicator::receive() const {
-    Q_ASSERT_X(_lxidev != LXI_ERROR, "LXICommunicator::send", "connection must be open");
+std::string LXICommunicator::_receive() const {
+    Q_ASSERT_X(_lxidev != LXI_ERROR, "LXICommunicator::receive", "connection must be open");
     char buf[1024];
     int num_bytes = sizeof(buf);
     std::string received;
     
-    QMutexLocker locker(&_mutex);
     while (num_bytes == sizeof(buf)) {
         num_bytes = lxi_receive(_lxidev, buf, sizeof(buf), timeout);
         if (num_bytes == LXI_ERROR) {
             qCritical("Error when receiving from LXI connection %s %i", _address.c_str(), _port);
+            _countTimeout();
             return received;
         }
         received.append(buf, num_bytes);
+        _countReceived(num_bytes);
     }
     qDebug("Received from %s %i: %s", _address.c_str(), _port, received.c_str());
     return received;
 }
 
-std::string LXICommunicator::query(const std::string& buf, int sleep_time) const {
-    send(buf);
-    QThread::msleep(sleep_time);
-    return receive();
-}
-
-std::string LXICommunicator::getLocDisplay() const {
-    std::string ret = "LXI ";
-    ret += _address;
-    ret += " ";
-    ret += _port;
-    return ret;
-}
-
 char* LXICommunicator::_get_cstr_copy(const std::string& str) const {
     char* cstr = new char[str.length() + 1];
     memcpy(cstr, str.c_str(), str.length() + 1);
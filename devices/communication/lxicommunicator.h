@@ -27,10 +27,21 @@ public:
     std::string receive() const override;
     std::string query(const std::string& buf, int sleep_time = 0) const override;
     
+    /**
+     * Sends all queries in one message, separated by semicolons as
+     * defined by IEEE 488.2, and splits the answer at the semicolons.
+     * The device thus only needs to be contacted once.
+     */
+    std::vector<std::string> queryBatch(const std::vector<std::string>& queries) const override;
+    
     std::string getLocDisplay() const override;
 
 private:
     char* _get_cstr_copy(const std::string& str) const;
+    
+    // Versions of send and receive expecting _mutex to be locked
+    void _send(const std::string& buf) const;
+    std::string _receive() const;
 
     std::string _address;
     int _port;
@@ -0,0 +1,100 @@
+#include "mockcommunicator.h"
+
+#include <QtGlobal>
+#include <QThread>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+
+MockCommunicator::MockCommunicator(InstrumentSimulator* simulator, int latency, int jitter)
+    : _latency(latency, jitter)
+{
+    _simulator = simulator;
+    _open = false;
+}
+
+MockCommunicator::~MockCommunicator() {
+    delete _simulator;
+}
+
+void MockCommunicator::open() {
+    QMutexLocker locker(&_mutex);
+    _answers.clear();
+    _open = true;
+}
+
+void MockCommunicator::close() {
+    QMutexLocker locker(&_mutex);
+    _open = false;
+}
+
+bool MockCommunicator::isOpen() const {
+    return _open;
+}
+
+void MockCommunicator::send(const std::string& buf) const {
+    StatsLocker locker(&_mutex, this);
+    _send(buf);
+}
+
+std::string MockCommunicator::receive() const {
+    StatsLocker locker(&_mutex, this);
+    return _receive();
+}
+
+std::string MockCommunicator::query(const std::string& buf, int sleep_time) const {
+    // Keep the lock so that no other thread can receive our answer
+    StatsLocker locker(&_mutex, this);
+    QElapsedTimer clock;
+    clock.start();
+    _answers.clear();
+    _send(buf);
+    if (sleep_time > 0)
+        QThread::msleep(sleep_time);
+    std::string answer = _receive();
+    _countQuery(clock.nsecsElapsed() / 1000);
+    return answer;
+}
+
+std::vector<std::string> MockCommunicator::queryBatch(const std::vector<std::string>& queries) const {
+    StatsLocker locker(&_mutex, this);
+    Q_ASSERT_X(_open, "MockCommunicator::queryBatch", "connection must be open");
+    QElapsedTimer clock;
+    clock.start();
+    QThread::msleep(_latency.next());
+
+    std::vector<std::string> answers;
+    for (const auto& q: queries) {
+        _countSent(q.length() + getSuffix().length());
+        answers.push_back(_simulator->respond(q));
+        _countReceived(answers.back().length());
+    }
+    _countQuery(clock.nsecsElapsed() / 1000);
+    return answers;
+}
+
+std::string MockCommunicator::getLocDisplay() const {
+    return "Simulated";
+}
+
+void MockCommunicator::_send(const std::string& buf) const {
+    Q_ASSERT_X(_open, "MockCommunicator::send", "connection must be open");
+    QThread::msleep(_latency.next());
+    _countSent(buf.length() + getSuffix().length());
+    std::string answer = _simulator->respond(buf);
+    if (not answer.empty())
+        _answers.push_back(answer);
+}
+
+std::string MockCommunicator::_receive() const {
+    Q_ASSERT_X(_open, "MockCommunicator::receive", "connection must be open");
+    if (_answers.empty()) {
+        QThread::msleep(timeout);
+        qCritical("Timeout reached when reading from simulated device");
+        _countTimeout();
+        return "";
+    }
+    std::string answer = _answers.front();
+    _answers.pop_front();
+    _countReceived(answer.length());
+    return answer;
+}
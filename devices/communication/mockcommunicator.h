@@ -0,0 +1,65 @@
+#ifndef MOCKCOMMUNICATOR_H
+#define MOCKCOMMUNICATOR_H
+
+#include "communicator.h"
+#include "devices/simulation/instrumentsimulator.h"
+
+#include <deque>
+#include <string>
+#include <QMutex>
+
+/**
+ * Communicate with a simulated device in the same process instead of a
+ * real one. Every message sent takes a configurable time, as if it went
+ * over the network and the device needed some time to process it.
+ */
+class MockCommunicator : public Communicator {
+public:
+    /**
+     * @param simulator The device. The communicator takes ownership
+     * @param latency Time in ms every message takes
+     * @param jitter Maximum deviation from latency in ms
+     */
+    MockCommunicator(InstrumentSimulator* simulator, int latency = 0, int jitter = 0);
+    virtual ~MockCommunicator();
+
+    MockCommunicator(MockCommunicator&& other) = delete;
+    MockCommunicator(const MockCommunicator& other) = delete;
+    MockCommunicator& operator=(const MockCommunicator& other) = delete;
+    MockCommunicator& operator=(MockCommunicator&& other) = delete;
+
+    void open() override;
+    void close() override;
+    bool isOpen() const override;
+    void send(const std::string& buf) const override;
+
+    /**
+     * Take the oldest answer of the device. If there is none, waits
+     * timeout ms like a real connection would.
+     */
+    std::string receive() const override;
+
+    std::string query(const std::string& buf, int sleep_time = 0) const override;
+
+    /**
+     * All queries are handled in a single round trip, like
+     * LXICommunicator does
+     */
+    std::vector<std::string> queryBatch(const std::vector<std::string>& queries) const override;
+
+    std::string getLocDisplay() const override;
+
+private:
+    // Versions of send and receive expecting _mutex to be locked
+    void _send(const std::string& buf) const;
+    std::string _receive() const;
+
+    InstrumentSimulator* _simulator;
+    bool _open;
+    mutable SimulatedLatency _latency;
+    mutable std::deque<std::string> _answers;
+
+    mutable QMutex _mutex;
+};
+
+#endif // MOCKCOMMUNICATOR_H
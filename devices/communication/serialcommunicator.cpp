@@ -0,0 +1,303 @@
+#include "serialcommunicator.h"
+#include "general/BurnInException.h"
+
+#include <QtGlobal>
+#include <QThread>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+SerialCommunicator::SerialCommunicator(const std::string& port, speed_t baud) {
+    _port = port;
+    _baud = baud;
+    _fd = -1;
+    _terminator = "\n";
+    _bufferStart = 0;
+    _bufferLength = 0;
+    memset(&_savedTermios, 0, sizeof(_savedTermios));
+}
+
+SerialCommunicator::~SerialCommunicator() {
+    if (isOpen())
+        close();
+}
+
+void SerialCommunicator::open() {
+    QMutexLocker locker(&_mutex);
+
+    // read/write | no term control | no DCD line check
+    _fd = ::open(_port.c_str(), O_RDWR | O_NOCTTY | O_NDELAY);
+    if (_fd == -1) {
+        qCritical("Could not open device file %s: %s", _port.c_str(), std::strerror(errno));
+        throw BurnInException("Could not open device file " + _port);
+    }
+    fcntl(_fd, F_SETFL, FNDELAY);
+
+    _configurePort();
+    _clearBuffer();
+}
+
+void SerialCommunicator::close() {
+    QMutexLocker locker(&_mutex);
+    if (_fd == -1)
+        return;
+
+    // Restore port settings as they were
+    tcsetattr(_fd, TCSANOW, &_savedTermios);
+    ::close(_fd);
+    _fd = -1;
+}
+
+bool SerialCommunicator::isOpen() const {
+    return _fd != -1;
+}
+
+void SerialCommunicator::send(const std::string& buf) const {
+    StatsLocker locker(&_mutex, this);
+    _send(buf);
+}
+
+std::string SerialCommunicator::receive() const {
+    StatsLocker locker(&_mutex, this);
+    return _receive();
+}
+
+std::string SerialCommunicator::query(const std::string& buf, int sleep_time) const {
+    // Keep the lock so that no other thread can receive our answer
+    StatsLocker locker(&_mutex, this);
+
+    // Left-overs, e.g. a late answer to a query that timed out, would
+    // otherwise be taken as the answer to this query
+    _clearBuffer();
+    tcflush(_fd, TCIFLUSH);
+
+    QElapsedTimer clock;
+    clock.start();
+    _send(buf);
+    if (sleep_time > 0)
+        QThread::msleep(sleep_time);
+    std::string received = _receive();
+    _countQuery(clock.nsecsElapsed() / 1000);
+    return received;
+}
+
+std::string SerialCommunicator::getLocDisplay() const {
+    return "Serial " + _port;
+}
+
+std::string SerialCommunicator::getTerminator() const {
+    return _terminator;
+}
+
+void SerialCommunicator::setTerminator(const std::string& terminator) {
+    _terminator = terminator;
+}
+
+void SerialCommunicator::_send(const std::string& buf) const {
+    // Closed if reconnecting after the connection was lost failed
+    if (_fd == -1) {
+        _countFailure();
+        throw BurnInException("Device file " + _port + " is not open");
+    }
+    std::string data = buf + getSuffix();
+    qDebug("Send to %s: %s", _port.c_str(), data.c_str());
+
+    // Write the whole buffer at once. The port is non-blocking, so the
+    // kernel might only take a part of it.
+    size_t written = 0;
+    while (written < data.length()) {
+        ssize_t n = write(_fd, data.c_str() + written, data.length() - written);
+        if (n >= 0) {
+            written += n;
+            continue;
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN) {
+            pollfd pfd = {_fd, POLLOUT, 0};
+            if (poll(&pfd, 1, timeout) > 0)
+                continue;
+        }
+        qCritical("Error while writing to %s: %s", _port.c_str(), std::strerror(errno));
+        _countSent(written);
+        _countFailure();
+        return;
+    }
+    _countSent(written);
+
+    // Wait until everything has been transmitted. Devices that don't
+    // answer to a command can take the next one afterwards. Unlike
+    // tcdrain this gives up after the timeout, e.g. if the device sent
+    // XOFF or the adapter stalled.
+    QElapsedTimer clock;
+    clock.start();
+    int queued;
+    while (ioctl(_fd, TIOCOUTQ, &queued) == 0 and queued > 0) {
+        if (clock.elapsed() >= timeout) {
+            qCritical("Timeout reached when writing to %s: %d bytes not transmitted", _port.c_str(), queued);
+            _countTimeout();
+            return;
+        }
+        QThread::msleep(1);
+    }
+}
+
+std::string SerialCommunicator::_receive() const {
+    Q_ASSERT_X(_fd != -1, "SerialCommunicator::receive", "connection must be open");
+    std::string data;
+    QElapsedTimer clock;
+    clock.start();
+
+    while (not _takeFromBuffer(data)) {
+        int remaining = timeout - static_cast<int>(clock.elapsed());
+        if (remaining <= 0 or not _readIntoBuffer(remaining)) {
+            qCritical("Timeout reached when reading from %s", _port.c_str());
+            _countTimeout();
+            return data;
+        }
+    }
+
+    qDebug("Read %zu bytes from %s: %s", data.length(), _port.c_str(), data.c_str());
+    return data;
+}
+
+bool SerialCommunicator::_takeFromBuffer(std::string& data) const {
+    if (_bufferLength == 0)
+        return false;
+
+    size_t length;
+    if (_terminator.empty()) {
+        length = _bufferLength;
+    } else {
+        // Search for the terminator. It might wrap around the end.
+        size_t i = 0;
+        size_t matched = 0;
+        for (; i < _bufferLength and matched < _terminator.length(); ++i) {
+            char c = _buffer[(_bufferStart + i) % BUFFER_SIZE];
+            if (c == _terminator[matched])
+                ++matched;
+            else
+                matched = (c == _terminator[0]) ? 1 : 0;
+        }
+
+        if (matched == _terminator.length()) {
+            length = i;
+        } else if (_bufferLength == BUFFER_SIZE) {
+            qWarning("Receive buffer for %s full without terminator", _port.c_str());
+            length = _bufferLength;
+        } else
+            return false;
+    }
+
+    data.clear();
+    data.reserve(length);
+    for (size_t i = 0; i < length; ++i)
+        data += _buffer[(_bufferStart + i) % BUFFER_SIZE];
+    _bufferStart = (_bufferStart + length) % BUFFER_SIZE;
+    _bufferLength -= length;
+
+    if (not _terminator.empty() and data.length() >= _terminator.length()
+            and data.compare(data.length() - _terminator.length(), _terminator.length(), _terminator) == 0)
+        data.erase(data.length() - _terminator.length());
+
+    return true;
+}
+
+bool SerialCommunicator::_readIntoBuffer(int wait_ms) const {
+    pollfd pfd = {_fd, POLLIN, 0};
+    int rv = poll(&pfd, 1, wait_ms);
+    if (rv == -1) {
+        if (errno == EINTR)
+            return true;
+        qCritical("Error when reading (poll) from %s: %s", _port.c_str(), std::strerror(errno));
+        return false;
+    } else if (rv == 0)
+        return false;
+
+    // Read into the free part of the ring buffer up to its end
+    size_t end = (_bufferStart + _bufferLength) % BUFFER_SIZE;
+    size_t space = (end >= _bufferStart) ? BUFFER_SIZE - end : _bufferStart - end;
+    if (_bufferLength == BUFFER_SIZE)
+        space = 0;
+    if (space == 0)
+        return true;
+
+    ssize_t len = read(_fd, _buffer + end, space);
+    if (len == -1) {
+        if (errno == EAGAIN or errno == EINTR)
+            return true;
+        qCritical("Error when reading (read) from %s: %s", _port.c_str(), std::strerror(errno));
+        return false;
+    }
+    _bufferLength += len;
+    _countReceived(len);
+    return true;
+}
+
+void SerialCommunicator::_clearBuffer() const {
+    _bufferStart = 0;
+    _bufferLength = 0;
+}
+
+void SerialCommunicator::_configurePort() {
+    termios settings;
+
+    // Save current settings for restoring them when closing
+    tcgetattr(_fd, &_savedTermios);
+
+    memset(&settings, 0, sizeof(settings));
+
+    cfsetispeed(&settings, _baud);
+    cfsetospeed(&settings, _baud);
+
+    // 8N1 (no parity, 1 stopbit)
+    settings.c_cflag &= ~PARENB;
+    settings.c_cflag &= ~PARODD;
+    settings.c_cflag |=  CS8;
+    settings.c_cflag |=  HUPCL;
+    settings.c_cflag &= ~CSTOPB;
+    settings.c_cflag |=  CREAD;
+    settings.c_cflag |=  CLOCAL;
+    settings.c_cflag &= ~CRTSCTS;
+
+    settings.c_lflag |=  ISIG;
+    settings.c_lflag |=  ICANON;
+    settings.c_lflag &= ~ECHO;
+    settings.c_lflag |=  ECHOE;
+    settings.c_lflag |=  ECHOK;
+    settings.c_lflag &= ~ECHONL;
+    settings.c_lflag |=  IEXTEN;
+
+    settings.c_iflag &= ~IGNBRK;
+    settings.c_iflag &= ~BRKINT;
+    settings.c_iflag &= ~IGNPAR;
+    settings.c_iflag &= ~PARMRK;
+    settings.c_iflag &= ~INPCK;
+    settings.c_iflag &= ~ISTRIP;
+    settings.c_iflag &= ~INLCR;
+    settings.c_iflag &= ~IGNCR;
+    // settings.c_iflag |=  ICRNL; // Do not enable
+    settings.c_iflag |=  IXON;
+    settings.c_iflag &= ~IXOFF;
+    settings.c_iflag &= ~IUCLC;
+    settings.c_iflag &= ~IXANY;
+    settings.c_iflag &= ~IMAXBEL;
+    settings.c_iflag &= ~IUTF8;
+
+    settings.c_oflag |=  OPOST;
+    settings.c_oflag &= ~OLCUC;
+    settings.c_oflag &= ~OCRNL;
+    settings.c_oflag |=  ONLCR;
+    settings.c_oflag &= ~ONOCR;
+    settings.c_oflag &= ~ONLRET;
+    settings.c_oflag &= ~OFILL;
+    settings.c_oflag &= ~OFDEL;
+
+    tcsetattr(_fd, TCSANOW, &settings);
+}
@@ -0,0 +1,90 @@
+#ifndef SERIALCOMMUNICATOR_H
+#define SERIALCOMMUNICATOR_H
+
+#include "communicator.h"
+
+#include <string>
+#include <termios.h>
+#include <QMutex>
+
+/**
+ * Communicate with a device over a serial port. Received data is
+ * collected in a ring buffer and handed out in pieces ending with the
+ * terminator, so receive returns as soon as the device has answered.
+ */
+class SerialCommunicator : public Communicator {
+public:
+    /**
+     * @param port Device file of the serial port, e.g. /dev/ttyS0
+     * @param baud Baud rate as defined by termios.h, e.g. B9600
+     */
+    SerialCommunicator(const std::string& port, speed_t baud = B9600);
+    virtual ~SerialCommunicator();
+
+    SerialCommunicator(SerialCommunicator&& other) = delete;
+    SerialCommunicator(const SerialCommunicator& other) = delete;
+    SerialCommunicator& operator=(const SerialCommunicator& other) = delete;
+    SerialCommunicator& operator=(SerialCommunicator&& other) = delete;
+
+    void open() override;
+    void close() override;
+    bool isOpen() const override;
+
+    /**
+     * Send data to the device. Returns after all of it has been
+     * transmitted over the line.
+     * @param buf Data to send. The suffix is attached
+     */
+    void send(const std::string& buf) const override;
+
+    /**
+     * Receive data up to the terminator. Waits at most timeout ms.
+     * @return Data received without the terminator. Empty on timeout
+     */
+    std::string receive() const override;
+
+    /**
+     * Discard data that was received before and hasn't been read yet,
+     * send the query and receive the answer.
+     */
+    std::string query(const std::string& buf, int sleep_time = 0) const override;
+
+    std::string getLocDisplay() const override;
+
+    /**
+     * Get the string that terminates a piece of data sent by the device
+     * @return The terminator
+     */
+    std::string getTerminator() const;
+
+    /**
+     * Set the string that terminates a piece of data sent by the device.
+     * The default is \n. If empty, receive returns everything that
+     * arrived as soon as anything arrived.
+     * @param terminator The terminator
+     */
+    void setTerminator(const std::string& terminator);
+
+private:
+    void _configurePort();
+    void _send(const std::string& buf) const;
+    std::string _receive() const;
+    bool _takeFromBuffer(std::string& data) const;
+    bool _readIntoBuffer(int wait_ms) const;
+    void _clearBuffer() const;
+
+    std::string _port;
+    speed_t _baud;
+    int _fd;
+    termios _savedTermios;
+    std::string _terminator;
+
+    static constexpr size_t BUFFER_SIZE = 4096;
+    mutable char _buffer[BUFFER_SIZE];
+    mutable size_t _bufferStart; // Index of the first unread byte
+    mutable size_t _bufferLength; // Number of unread bytes
+
+    mutable QMutex _mutex;
+};
+
+#endif // SERIALCOMMUNICATOR_H
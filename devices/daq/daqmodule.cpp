@@ -20,22 +20,23 @@ DAQModule::DAQModule(const QString& fc7Port, const QString& controlhubPath, cons
 	_daqHwdescPath = daqHwdescPath;
 	_daqImagePath = daqImagePath;
 	
-	_fc7Port = new char[fc7Port.length() + 1];
-	strcpy(_fc7Port, fc7Port.toUtf8().constData());
-	_fc7comhandler = nullptr;
-	_fc7power = false;
-	
 	// Check if all needed files are accessible
 	if (not QFileInfo(_contrStartPath).isExecutable())
 		throw BurnInException("Can not execute controlhub_start in controlhubPath " + _contrStartPath.toStdString());
 	if (not QFileInfo(_daqHwdescPath).isReadable())
 		throw BurnInException("Can not read daqHwdescFile " + _daqHwdescPath.toStdString());
+	
+	// FC7 arduino runs at 9600 baud. For every char send to it, it
+	// responses with the state of the device ('0' or '1'). Sending a
+	// '0' (a char without line feed) turns the device off, a '1' turns
+	// it on.
+	_fc7comm = new SerialCommunicator(fc7Port.toStdString(), B9600);
+	_fc7power = false;
+	_useTerminal = true;
 }
 
 DAQModule::~DAQModule() {
-	delete[] _fc7Port;
-	if (_fc7comhandler != nullptr)
-		delete _fc7comhandler;
+	delete _fc7comm;
 }
 
 void DAQModule::initialize() {
@@ -43,22 +44,14 @@ void DAQModule::initialize() {
 	if (not QProcess::startDetached(_contrStartPath, {}))
 		throw BurnInException("Unable to start the controlhub " + _contrStartPath.toStdString());
 		
-	// FC7 arduino runs at 9600 baud. For every char send to it, it
-	// responses with the state of the device ('0' or '1'). Sending a
-	// '0' (a char without line feed) turns the device off, a '1' turns
-	// it on.
-	_fc7comhandler = new ComHandler(_fc7Port, B9600);
+	_fc7comm->open();
 	
-	// Get whether FC7 is powered on
-	char buf[1024];
-	_fc7comhandler->SendCommand ("2", false);
-	// wait for arduino to process this
-	// 1000 from comhandler...
-	QThread::usleep(FC7SLEEP);
-	_fc7comhandler->ReceiveString(buf);
-	if (buf[0] == '0') {
+	// Get whether FC7 is powered on. Returns as soon as the arduino
+	// answered.
+	std::string buf = _fc7comm->query("2");
+	if (buf.length() > 0 and buf[0] == '0') {
 		_fc7power = false;
-	} else if (buf[0] == '1') {
+	} else if (buf.length() > 0 and buf[0] == '1') {
 		_fc7power = true;
 	} else
 		throw BurnInException("Can't get FC7 power status!");
@@ -77,14 +70,9 @@ QString DAQModule::_pathjoin(const std::initializer_list<const QString>& parts)
 }
 
 void DAQModule::setFC7Power(bool power) {
-	if (power)
-		_fc7comhandler->SendCommand("1", false);
-	else
-		_fc7comhandler->SendCommand("0", false);
-	
-	char buf[1024];
-	QThread::usleep(FC7SLEEP);
-	_fc7comhandler->ReceiveString(buf);
+	std::string buf = _fc7comm->query(power ? "1" : "0");
+	if (buf.empty())
+		buf = " ";
 	switch (buf[0]) {
 	case '0':
 		_fc7power = false;
@@ -126,11 +114,17 @@ QStringList DAQModule::getAvailableACFBinaries() const {
 	return QDir(_pathjoin({_ph2acfPath, "bin"})).entryList(QDir::Files | QDir::Executable);
 }
 
+void DAQModule::setUseTerminal(bool useTerminal) {
+	_useTerminal = useTerminal;
+}
+
+bool DAQModule::getUseTerminal() const {
+	return _useTerminal;
+}
+
 void DAQModule::loadFirmware() const {
-	QProcess fpgaconfig;
-	
-	QString cmd = _ph2SetupCommand + "; \"" + _ph2FpgaConfigPath + "\" -c \"" + _daqHwdescPath + "\" -i \"" + _daqImagePath + "\"; read";
-	if (not fpgaconfig.startDetached("/usr/bin/konsole", {"--hide-menubar", "--hide-tabbar", "-p", "HistoryMode=2", "-e", "bash", "-c", cmd}))
+	QString cmd = _ph2SetupCommand + "; \"" + _ph2FpgaConfigPath + "\" -c \"" + _daqHwdescPath + "\" -i \"" + _daqImagePath + "\"";
+	if (not _startCommand(cmd))
 		throw BurnInException("Unable to load firmware. Command: " + cmd.toStdString());
 }
 
@@ -139,9 +133,9 @@ void DAQModule::runACFBinary(const QString& execName, QString switches, bool app
 	if (appendHWDesc)
 		switches = "-f \"" + _daqHwdescPath + "\" " + switches;
 	
-	QString cmd = _ph2SetupCommand + "; \"" + path + "\" " + switches + "; read";
+	QString cmd = _ph2SetupCommand + "; \"" + path + "\" " + switches;
 	qDebug("Running DAQ command %s", cmd.toStdString().c_str());
-	if (not QProcess::startDetached("/usr/bin/konsole", {"--hide-menubar", "--hide-tabbar", "-p", "HistoryMode=2", "-e", "bash", "-c", cmd}))
+	if (not _startCommand(cmd))
 		throw BurnInException("Unable to run" + execName.toStdString() + ". Command: " + cmd.toStdString());
 }
 
@@ -151,3 +145,11 @@ void DAQModule::runACFBinary(const QString& execName, const QVector<QString>& sw
 		switches_str += "\"" + s + "\" ";
 	runACFBinary(execName, switches_str, appendHWDesc);
 }
+
+bool DAQModule::_startCommand(const QString& cmd) const {
+	if (not _useTerminal)
+		return QProcess::startDetached("/bin/bash", {"-c", cmd});
+	
+	// Keep the window open until enter is pressed
+	return QProcess::startDetached("/usr/bin/konsole", {"--hide-menubar", "--hide-tabbar", "-p", "HistoryMode=2", "-e", "bash", "-c", cmd + "; read"});
+}
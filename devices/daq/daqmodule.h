@@ -2,7 +2,7 @@
 #define DAQMODULE_H
 
 #include "devices/genericinstrumentclass.h"
-#include "devices/ComHandler.h"
+#include "devices/communication/serialcommunicator.h"
 
 #include <QObject>
 #include <QString>
@@ -33,8 +33,16 @@ public:
     void loadFirmware() const;
     
     /**
-     *  Run a binary from the bin directory of the Ph2_ACF in an extra
-     *  terminal window.
+     *  Whether DAQ commands are run in an extra terminal window (konsole).
+     *  If disabled, they run in the background with their output going
+     *  to the output of this program. Enabled by default.
+     */
+    void setUseTerminal(bool useTerminal);
+    bool getUseTerminal() const;
+    
+    /**
+     *  Run a binary from the bin directory of the Ph2_ACF, see
+     *  setUseTerminal.
      *  execName: Name of the binary to run
      *  switches: Arguments to pass when executing, either separated by
      *            spaces or as seperate strings in a vector
@@ -42,8 +50,6 @@ public:
      */
     void runACFBinary(const QString& execName, QString switches, bool appendHWDesc) const;
     void runACFBinary(const QString& execName, const QVector<QString>& switches = {}, bool appendHWDesc = true) const;
-    
-    const int FC7SLEEP = 10000; //us
 
 signals:
     void fc7PowerChanged(bool);
@@ -58,11 +64,12 @@ private:
     QString _daqHwdescPath;
     QString _daqImagePath;
     
-    char* _fc7Port;
-    ComHandler* _fc7comhandler;
+    SerialCommunicator* _fc7comm;
     bool _fc7power;
+    bool _useTerminal;
     
     QString _pathjoin(const std::initializer_list<const QString>& parts) const;
+    bool _startCommand(const QString& cmd) const;
 };
 
 #endif // DAQMODULE_H
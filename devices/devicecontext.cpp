@@ -0,0 +1,117 @@
+#include "devicecontext.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+
+#include <exception>
+#include <future>
+
+#include "general/BurnInException.h"
+
+const QEvent::Type DeviceContext::OperationEvent::TYPE = static_cast<QEvent::Type>(QEvent::registerEventType());
+
+DeviceContext::OperationEvent::OperationEvent(quint64 id, std::function<void()> operation) :
+    QEvent(TYPE),
+    id(id),
+    operation(operation)
+{
+}
+
+DeviceContext::DeviceContext(const std::string& name) {
+    _name = name;
+    _nextId = 1;
+    _stopped = false;
+
+    moveToThread(&_thread);
+    _thread.start();
+}
+
+DeviceContext::~DeviceContext() {
+    stop();
+}
+
+quint64 DeviceContext::post(std::function<void()> operation) {
+    quint64 id = _nextId++;
+    QCoreApplication::postEvent(this, new OperationEvent(id, operation));
+    return id;
+}
+
+void DeviceContext::call(std::function<void()> operation) {
+    if (QThread::currentThread() == &_thread) {
+        operation();
+        return;
+    }
+
+    // Either the thread runs the operation or stop() has returned, never
+    // both at the same time. Operations posted before the quit of stop()
+    // are still handled by the thread.
+    QMutexLocker locker(&_stopMutex);
+    if (_stopped) {
+        locker.unlock();
+        operation();
+        return;
+    }
+
+    std::promise<void> done;
+    std::future<void> result = done.get_future();
+    QCoreApplication::postEvent(this, new OperationEvent(0, [&operation, &done]() {
+        try {
+            operation();
+            done.set_value();
+        } catch (...) {
+            done.set_exception(std::current_exception());
+        }
+    }));
+    locker.unlock();
+    // Rethrows what the operation threw
+    result.get();
+}
+
+void DeviceContext::stop() {
+    Q_ASSERT_X(QThread::currentThread() != &_thread, "DeviceContext::stop", "can't wait for its own thread");
+    QMutexLocker locker(&_stopMutex);
+    if (_stopped)
+        return;
+    // Operations posted before are handled before the quit
+    QCoreApplication::postEvent(this, new OperationEvent(0, [this]() {
+        _thread.quit();
+    }));
+    _thread.wait();
+    _stopped = true;
+}
+
+void DeviceContext::setName(const std::string& name) {
+    _name = name;
+}
+
+std::string DeviceContext::getName() const {
+    return _name;
+}
+
+QThread* DeviceContext::getThread() {
+    return &_thread;
+}
+
+void DeviceContext::customEvent(QEvent* event) {
+    if (event->type() != OperationEvent::TYPE)
+        return;
+
+    OperationEvent* operationEvent = static_cast<OperationEvent*>(event);
+    QString error;
+    try {
+        operationEvent->operation();
+    } catch (const BurnInException& e) {
+        error = QString::fromStdString(e.what());
+        qCritical("Error on %s: %s", _name.c_str(), e.what());
+    } catch (const std::exception& e) {
+        // E.g. parsing an invalid answer. Must not leave the event loop
+        error = QString::fromStdString(e.what());
+        qCritical("Unexpected error on %s: %s", _name.c_str(), e.what());
+    } catch (...) {
+        error = "Unknown error";
+        qCritical("Unknown error on %s", _name.c_str());
+    }
+    // Operations of call report to the caller
+    if (operationEvent->id != 0)
+        emit operationFinished(operationEvent->id, error);
+}
@@ -0,0 +1,90 @@
+#ifndef DEVICECONTEXT_H
+#define DEVICECONTEXT_H
+
+#include <QObject>
+#include <QMutex>
+#include <QThread>
+#include <QEvent>
+#include <QString>
+
+#include <atomic>
+#include <functional>
+
+/**
+ * Thread of one device with a mailbox of operations. Everything talking
+ * to the device is posted here, so the I/O of a device is serialized
+ * without a lock and a slow device only blocks its own thread.
+ */
+class DeviceContext : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param name Name of the device, used for log messages
+     */
+    explicit DeviceContext(const std::string& name = "");
+    virtual ~DeviceContext();
+
+    DeviceContext(const DeviceContext& other) = delete;
+    DeviceContext& operator=(const DeviceContext& other) = delete;
+
+    /**
+     * Queue an operation and return immediately. Operations run one
+     * after the other in the order they were posted.
+     * @return Id of the operation, passed to operationFinished
+     */
+    quint64 post(std::function<void()> operation);
+
+    /**
+     * Queue an operation and wait for it to finish. Runs the operation
+     * right away if called from the thread of the context or after stop
+     * returned.
+     * @throw BurnInException or whatever else the operation threw
+     */
+    void call(std::function<void()> operation);
+
+    /**
+     * Finish the queued operations and stop the thread
+     */
+    void stop();
+
+    void setName(const std::string& name);
+    std::string getName() const;
+
+    /**
+     * @return The thread the operations run on
+     */
+    QThread* getThread();
+
+signals:
+    /**
+     * Emitted on the thread of the context after a posted operation
+     * @param id Id returned by post
+     * @param error Message of the exception thrown by the operation,
+     *     empty if it succeeded
+     */
+    void operationFinished(quint64 id, QString error);
+
+protected:
+    void customEvent(QEvent* event) override;
+
+private:
+    class OperationEvent : public QEvent {
+    public:
+        OperationEvent(quint64 id, std::function<void()> operation);
+
+        static const QEvent::Type TYPE;
+
+        quint64 id;
+        std::function<void()> operation;
+    };
+
+    std::string _name;
+    std::atomic<quint64> _nextId;
+    QThread _thread;
+    QMutex _stopMutex;
+    bool _stopped; // Guarded by _stopMutex
+};
+
+#endif // DEVICECONTEXT_H
@@ -24,37 +24,51 @@
 //#####################
 
 #include "HuberPetiteFleur.h"
+#include "devices/communication/serialcommunicator.h"
 #include "general/BurnInException.h"
 
-const double TEMP_EPSILON = 1.e-3;
+const size_t ANSWER_MAXLEN = 999; // All answer buffers are 1000 bytes long
 
 HuberPetiteFleur::HuberPetiteFleur(const ioport_t ioPort) {
   ioPort_ = ioPort;
-  comHandler_ = nullptr;
+  comm_ = nullptr;
   isCommunication_ = false;
   
-  alwaysEmit_ = true;
   circulatorOn_ = false;
   workingTemperature_ = 0;
+  targetTemperature_ = 0;
+  targetCirculatorOn_ = false;
   bathTemperature_ = 0;
 }
 HuberPetiteFleur::HuberPetiteFleur(const std::string& ioPort) {
   ioPort_ = ioPort;
-  comHandler_ = nullptr;
+  comm_ = nullptr;
   isCommunication_ = false;
   
-  alwaysEmit_ = true;
   circulatorOn_ = false;
   workingTemperature_ = 0;
+  targetTemperature_ = 0;
+  targetCirculatorOn_ = false;
   bathTemperature_ = 0;
 }
 
+HuberPetiteFleur::~HuberPetiteFleur() {
+  if (comm_ != nullptr)
+    delete comm_;
+}
+
 void HuberPetiteFleur::initialize() {
-  alwaysEmit_ = true;
-  comHandler_ = new ComHandler(ioPort_.c_str());
+  // Every reading of the new connection is emitted once
+  getChangeFilter()->reset();
+  comm_ = new SerialCommunicator(ioPort_);
+  comm_->setSuffix("\n");
+  comm_->open();
   Device_Init();
   refreshDeviceState();
-  alwaysEmit_ = false;
+  
+  // Kept as the chiller was found until they are set
+  targetTemperature_ = workingTemperature_;
+  targetCirculatorOn_ = circulatorOn_;
 }
 
 void HuberPetiteFleur::refreshDeviceState() {
@@ -88,9 +102,10 @@ bool HuberPetiteFleur::SetWorkingTemperature(const float workingTemp) {
   }
   
   float newtemp = static_cast<float>(oTemp) / 100;
-  if (alwaysEmit_ or std::abs(workingTemperature_ - newtemp) > TEMP_EPSILON)
+  if (_reportState("working_temperature", 0, newtemp))
     emit workingTemperatureChanged(newtemp);
   workingTemperature_ = oTemp;
+  targetTemperature_ = newtemp;
   
   return true;
 }
@@ -108,9 +123,10 @@ bool HuberPetiteFleur::SetCirculatorOn() {
     return false;
   }
   
-  if (alwaysEmit_ or not circulatorOn_)
+  if (_reportState("circulator", 0, 1))
     emit circulatorStatusChanged(true);
   circulatorOn_ = true;
+  targetCirculatorOn_ = true;
 
   return true;
 }
@@ -123,14 +139,15 @@ bool HuberPetiteFleur::SetCirculatorOff() {
   
   SetAndConfirm("CA@ +00000", buffer);
 
-  if(ToInteger(buffer) != 1) {
+  if(ToInteger(buffer) != 0) {
     qCritical("HuberPetiteFleur reported wrong circulator status \"%s\" after it was set to 0", buffer);
     return false;
   }
   
-  if (alwaysEmit_ or not circulatorOn_)
+  if (_reportState("circulator", 0, 0))
     emit circulatorStatusChanged(false);
   circulatorOn_ = false;
+  targetCirculatorOn_ = false;
 
   return true;
 }
@@ -144,8 +161,8 @@ float HuberPetiteFleur::GetBathTemperature() const {
   GetValue("TI?", buffer);
   float temp = ToFloat(buffer);
   
-  if (alwaysEmit_ or abs(temp - bathTemperature_) > TEMP_EPSILON)
-    emit workingTemperatureChanged(temp);
+  if (_reportChange("bath_temperature", 0, temp))
+    emit bathTemperatureChanged(temp);
   bathTemperature_ = temp;
 
   return temp;
@@ -160,7 +177,7 @@ float HuberPetiteFleur::GetWorkingTemperature() const {
   GetValue("SP?", buffer);
   float temp = atof(buffer);
   
-  if (alwaysEmit_ or abs(temp - workingTemperature_) > TEMP_EPSILON)
+  if (_reportState("working_temperature", 0, temp))
     emit workingTemperatureChanged(temp);
   workingTemperature_ = temp;
 
@@ -177,7 +194,7 @@ bool HuberPetiteFleur::GetCirculatorStatus() const {
 
   bool status = ToInteger(buffer);
 
-  if (alwaysEmit_ or circulatorOn_ != status)
+  if (_reportState("circulator", 0, status))
     emit circulatorStatusChanged(status);
   circulatorOn_ = status;
   
@@ -198,18 +215,16 @@ void HuberPetiteFleur::StripBuffer( char* buffer ) const {
 }
 
 void HuberPetiteFleur::GetValue(const char* command, char* buffer) const {
-  QMutexLocker locker( &comMutex_ );
-  comHandler_->SendCommand( command );
-  usleep( 250000 );
-  comHandler_->ReceiveString( buffer );
+  std::string answer = comm_->query( command );
+  strncpy( buffer, answer.c_str(), ANSWER_MAXLEN );
+  buffer[ANSWER_MAXLEN] = 0;
   StripBuffer( buffer );
 }
 
 void HuberPetiteFleur::SetAndConfirm(const char* command, char* buffer) const {
-  QMutexLocker locker( &comMutex_ );
-  comHandler_->SendCommand( command );
-  usleep( 250000 );
-  comHandler_->ReceiveString( buffer );
+  std::string answer = comm_->query( command );
+  strncpy( buffer, answer.c_str(), ANSWER_MAXLEN );
+  buffer[ANSWER_MAXLEN] = 0;
   StripBuffer( buffer );
 }
 
@@ -253,3 +268,21 @@ float HuberPetiteFleur::GetMinTemp() const {
 float HuberPetiteFleur::GetMaxTemp() const {
   return PetiteFleurUpperTempLimit;
 }
+
+Communicator* HuberPetiteFleur::_getCommunicator() const {
+  return comm_;
+}
+
+void HuberPetiteFleur::_restoreState() {
+  if (not SetWorkingTemperature(targetTemperature_))
+    throw BurnInException("HuberPetiteFleur didn't take the working temperature");
+  bool ok = targetCirculatorOn_ ? SetCirculatorOn() : SetCirculatorOff();
+  if (not ok)
+    throw BurnInException("HuberPetiteFleur didn't take the circulator status");
+}
+
+CommunicationStats HuberPetiteFleur::getStats() const {
+  if (comm_ == nullptr)
+    return CommunicationStats();
+  return comm_->getStats();
+}
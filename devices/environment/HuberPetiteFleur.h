@@ -16,11 +16,10 @@
 #define __HUBERPETITEFLEUR_H
 
 #include "devices/environment/chiller.h"
-#include "devices/ComHandler.h"
 #include <string>
-#include <QMutex>
 
-class PetiteFleurComHandler;
+typedef const char* ioport_t;
+class SerialCommunicator;
 
 class HuberPetiteFleur : public Chiller
 {
@@ -30,10 +29,12 @@ class HuberPetiteFleur : public Chiller
 
   HuberPetiteFleur(const ioport_t ioPort);
   HuberPetiteFleur(const std::string& ioPort);
+  virtual ~HuberPetiteFleur();
   
   void initialize();
   
   void refreshDeviceState();
+  CommunicationStats getStats() const override;
 
   bool SetWorkingTemperature(const float); //SP@
   bool SetCirculatorOn(); //CA@ +00001
@@ -49,6 +50,10 @@ class HuberPetiteFleur : public Chiller
   static constexpr int PetiteFleurLowerTempLimit = -40;
   static constexpr int PetiteFleurUpperTempLimit = 40;
 
+ protected:
+  Communicator* _getCommunicator() const override;
+  void _restoreState() override;
+
  private:
   
   void StripBuffer(char*) const;
@@ -59,14 +64,16 @@ class HuberPetiteFleur : public Chiller
 
   std::string ioPort_;
   void Device_Init();
-  ComHandler* comHandler_;
-  mutable QMutex comMutex_;
+  SerialCommunicator* comm_;
   bool isCommunication_;
   
-  bool alwaysEmit_;
   mutable bool circulatorOn_;
   mutable float workingTemperature_;
   mutable float bathTemperature_;
+  
+  // As set by the user, sent again after reconnecting
+  float targetTemperature_;
+  bool targetCirculatorOn_;
 };
 
 #endif
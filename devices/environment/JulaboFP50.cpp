@@ -16,13 +16,12 @@
 #include <string>
 #include <sstream>
 #include <cstdlib>
+#include <cstring>
 #include <utility>
 #include <fstream>
 
-#include <QMutexLocker> 
-
 #include "JulaboFP50.h"
-#include "devices/ComHandler.h"
+#include "devices/communication/serialcommunicator.h"
 #include "general/BurnInException.h"
 
 //#####################
@@ -31,6 +30,7 @@
 //#####################
 
 const double TEMP_EPSILON = 1.e-3;
+const size_t ANSWER_MAXLEN = 199; // All answer buffers are at least 200 bytes long
 
 ///
 ///
@@ -39,12 +39,13 @@ JulaboFP50::JulaboFP50( const ioport_t ioPort )
 
 {
   ioPort_ = ioPort;
-  comHandler_ = nullptr;
+  comm_ = nullptr;
   isCommunication_ = false;
   
-  alwaysEmit_ = true;
   circulatorOn_ = false;
   workingTemperature_ = 0;
+  targetTemperature_ = 0;
+  targetCirculatorOn_ = false;
   bathTemperature_ = 0;
   sensorTemperature_ = 0;
   pumpPressure_ = 0;
@@ -52,23 +53,35 @@ JulaboFP50::JulaboFP50( const ioport_t ioPort )
 
 JulaboFP50::JulaboFP50(const std::string& ioPort) {
   ioPort_ = ioPort;
-  comHandler_ = nullptr;
+  comm_ = nullptr;
   isCommunication_ = false;
   
-  alwaysEmit_ = true;
   circulatorOn_ = false;
   workingTemperature_ = 0;
+  targetTemperature_ = 0;
+  targetCirculatorOn_ = false;
   bathTemperature_ = 0;
   sensorTemperature_ = 0;
   pumpPressure_ = 0;
 }
 
+JulaboFP50::~JulaboFP50() {
+  if (comm_ != nullptr)
+    delete comm_;
+}
+
 void JulaboFP50::initialize() {
-  alwaysEmit_ = true;
-  comHandler_ = new ComHandler( ioPort_.c_str() );
+  // Every reading of the new connection is emitted once
+  getChangeFilter()->reset();
+  comm_ = new SerialCommunicator( ioPort_ );
+  comm_->setSuffix( "\n" );
+  comm_->open();
   Device_Init();
   refreshDeviceState();
-  alwaysEmit_ = false;
+  
+  // Kept as the chiller was found until they are set
+  targetTemperature_ = workingTemperature_;
+  targetCirculatorOn_ = circulatorOn_;
 }
 
 void JulaboFP50::refreshDeviceState() {
@@ -98,9 +111,10 @@ bool JulaboFP50::SetWorkingTemperature( const float workingTemp ) {
     return false;
   }
   
-  if (alwaysEmit_ or std::abs(workingTemperature_ - newtemp) > TEMP_EPSILON)
+  if (_reportState("working_temperature", 0, newtemp))
     emit workingTemperatureChanged(newtemp);
   workingTemperature_ = newtemp;
+  targetTemperature_ = newtemp;
 
   return true;
 }
@@ -124,7 +138,7 @@ bool JulaboFP50::SetPumpPressure( const unsigned int pressureStage ) {
     return false;
   }
   
-  if (alwaysEmit_ or pumpPressure_ != pressureStage)
+  if (_reportState("pump_pressure", 0, pressureStage))
     emit pumpPressureChanged(pressureStage);
   pumpPressure_ = pressureStage;
 
@@ -145,9 +159,10 @@ bool JulaboFP50::SetCirculatorOn( void ) {
     return false;
   }
   
-  if (alwaysEmit_ or not circulatorOn_)
+  if (_reportState("circulator", 0, 1))
     emit circulatorStatusChanged(true);
   circulatorOn_ = true;
+  targetCirculatorOn_ = true;
 
   return true;
 }
@@ -166,9 +181,10 @@ bool JulaboFP50::SetCirculatorOff( void ) {
     return false;
   }
   
-  if (alwaysEmit_ or circulatorOn_)
+  if (_reportState("circulator", 0, 0))
     emit circulatorStatusChanged(false);
   circulatorOn_ = false;
+  targetCirculatorOn_ = false;
 
   return true;
 }
@@ -224,7 +240,7 @@ float JulaboFP50::GetBathTemperature( void ) const {
   GetValue("in_pv_00", buffer);
   float temp = atof( buffer );
   
-  if (alwaysEmit_ or abs(temp - bathTemperature_) > TEMP_EPSILON)
+  if (_reportChange("bath_temperature", 0, temp))
     emit bathTemperatureChanged(temp);
   bathTemperature_ = temp;
   
@@ -241,7 +257,7 @@ float JulaboFP50::GetSafetySensorTemperature( void ) const {
   GetValue("in_pv_03", buffer);
   float temp = atof( buffer );
   
-  if (alwaysEmit_ or abs(temp - sensorTemperature_) > TEMP_EPSILON)
+  if (_reportChange("safety_sensor_temperature", 0, temp))
     emit safetySensorTemperatureChanged(temp);
   sensorTemperature_ = temp;
 
@@ -258,7 +274,7 @@ float JulaboFP50::GetWorkingTemperature( void ) const {
   GetValue("in_sp_00", buffer);
   float temp = atof( buffer );
   
-  if (alwaysEmit_ or abs(temp - workingTemperature_) > TEMP_EPSILON)
+  if (_reportState("working_temperature", 0, temp))
     emit workingTemperatureChanged(temp);
   workingTemperature_ = temp;
 
@@ -287,9 +303,16 @@ unsigned int JulaboFP50::GetPumpPressure( void ) const {
   char buffer[1000];
   
   GetValue("in_sp_07", buffer);
-  unsigned int pressure = stoi( buffer );
+  // Empty if the read timed out
+  char* end;
+  long stage = strtol( buffer, &end, 10 );
+  if( end == buffer or stage < 0 ) {
+    qCritical("JulaboFP50 sent an invalid pump pressure \"%s\"", buffer);
+    return pumpPressure_;
+  }
+  unsigned int pressure = static_cast<unsigned int>( stage );
   
-  if (alwaysEmit_ or pressure != pumpPressure_)
+  if (_reportState("pump_pressure", 0, pressure))
     emit pumpPressureChanged(pressure);
   pumpPressure_ = pressure;
 
@@ -307,7 +330,7 @@ bool JulaboFP50::GetCirculatorStatus( void ) const {
 
   bool status = atoi( buffer );
 
-  if (alwaysEmit_ or circulatorOn_ != status)
+  if (_reportState("circulator", 0, status))
     emit circulatorStatusChanged(status);
   circulatorOn_ = status;
   
@@ -466,20 +489,19 @@ void JulaboFP50::StripBuffer( char* buffer ) const {
 }
 
 void JulaboFP50::GetValue(const char* command, char* buffer) const {
-  QMutexLocker locker(&comMutex_);
-  comHandler_->SendCommand( command );
-  usleep( 10000 );
-  comHandler_->ReceiveString( buffer );
+  std::string answer = comm_->query( command );
+  strncpy( buffer, answer.c_str(), ANSWER_MAXLEN );
+  buffer[ANSWER_MAXLEN] = 0;
   StripBuffer( buffer );
 }
 
 void JulaboFP50::SetAndConfirm(const char* first, const char* second, char* buffer) const {
-  QMutexLocker locker(&comMutex_);
-  comHandler_->SendCommand( first );
-  usleep( 20000 );
-  comHandler_->SendCommand( second );
-  usleep( 10000 );
-  comHandler_->ReceiveString( buffer );
+  // send returns once the command has left the port, so the
+  // confirmation can be queried right away
+  comm_->send( first );
+  std::string answer = comm_->query( second );
+  strncpy( buffer, answer.c_str(), ANSWER_MAXLEN );
+  buffer[ANSWER_MAXLEN] = 0;
   StripBuffer( buffer );
 }
 
@@ -489,12 +511,9 @@ void JulaboFP50::SetAndConfirm(const char* first, const char* second, char* buff
 ///
 void JulaboFP50::Device_Init( void ) {
 
-  char buffer[200];
-  comHandler_->SendCommand( "version" );
-  usleep( 200000 );
-  comHandler_->ReceiveString( buffer );
+  std::string answer = comm_->query( "version" );
 
-  if (std::string::npos==std::string(buffer).find( "JULABO TOPTECH-SERIES MC-2 VERSION")) {
+  if (std::string::npos==answer.find( "JULABO TOPTECH-SERIES MC-2 VERSION")) {
     isCommunication_ = false;
     
     throw BurnInException("Invalid or no device at address of Julabo chiller");
@@ -510,3 +529,21 @@ float JulaboFP50::GetMinTemp( void ) const {
 float JulaboFP50::GetMaxTemp( void ) const {
   return FP50UpperTempLimit;
 }
+
+Communicator* JulaboFP50::_getCommunicator() const {
+  return comm_;
+}
+
+void JulaboFP50::_restoreState() {
+  if (not SetWorkingTemperature(targetTemperature_))
+    throw BurnInException("JulaboFP50 didn't take the working temperature");
+  bool ok = targetCirculatorOn_ ? SetCirculatorOn() : SetCirculatorOff();
+  if (not ok)
+    throw BurnInException("JulaboFP50 didn't take the circulator status");
+}
+
+CommunicationStats JulaboFP50::getStats() const {
+  if (comm_ == nullptr)
+    return CommunicationStats();
+  return comm_->getStats();
+}
@@ -22,12 +22,11 @@
 #include <utility>
 #include <fstream>
 
-#include <QMutex>
 
 #include "devices/environment/chiller.h"
 
 typedef const char* ioport_t;
-class ComHandler;
+class SerialCommunicator;
 class JulaboFP50: public Chiller
 {
   Q_OBJECT
@@ -36,10 +35,12 @@ class JulaboFP50: public Chiller
 
   JulaboFP50( ioport_t );
   JulaboFP50( const std::string& ioPort );
+  virtual ~JulaboFP50();
   
   void initialize();
   
   void refreshDeviceState();
+  CommunicationStats getStats() const override;
 
   bool SetWorkingTemperature( const float );
   bool SetPumpPressure( const unsigned int );
@@ -69,26 +70,29 @@ class JulaboFP50: public Chiller
   static constexpr int FP50UpperTempLimit =  55;
   
 signals:
-  void circulatorStatusChanged(bool on) const;
-  void workingTemperatureChanged(float temperature) const;
-  void bathTemperatureChanged(float temperature) const;
   void safetySensorTemperatureChanged(float temperature) const;
   void pumpPressureChanged(unsigned int pressureStage) const;
 
+ protected:
+  Communicator* _getCommunicator() const override;
+  void _restoreState() override;
+
  private:
   void GetValue(const char* command, char* buffer) const;
   void SetAndConfirm(const char* first, const char* second, char* buffer) const;
 
   std::string ioPort_;
   void Device_Init( void );
-  ComHandler* comHandler_;
-  mutable QMutex comMutex_;
+  SerialCommunicator* comm_;
   bool isCommunication_;
   
-  bool alwaysEmit_;
   mutable bool circulatorOn_;
   mutable float workingTemperature_;
   mutable float bathTemperature_;
+  
+  // As set by the user, sent again after reconnecting
+  float targetTemperature_;
+  bool targetCirculatorOn_;
   mutable float sensorTemperature_;
   mutable unsigned int pumpPressure_;
 
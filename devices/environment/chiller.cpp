@@ -1,6 +1,8 @@
 #include "chiller.h"
 
+const double TEMPERATURE_DEADBAND = 1.e-3; // °C, used if the hardware description sets none
+
 Chiller::Chiller()
 {
-
+    getChangeFilter()->setDefaultDeadband(TEMPERATURE_DEADBAND);
 }
@@ -1,43 +1,51 @@
 #include "thermorasp.h"
 
+#include <algorithm>
 #include <iostream>
 #include <QTextCodec>
 #include <QThread>
+#include <QTimer>
+#include <QMutexLocker>
 #include <QRegularExpression>
+#include <QtNumeric>
 
 using namespace std;
 
+// Limits of the waiting time between connection attempts in ms
+const int BACKOFF_MIN = 1000;
+const int BACKOFF_MAX = 60000;
+
 Thermorasp::Thermorasp(const QString& address, quint16 port) {
     _address = address;
     _port = port;
+    _streaming = false;
+    _sock = nullptr;
+    _timeoutTimer = nullptr;
+    _retryAt = 0;
+    _backoff = 0;
+    _clock.start();
 }
 
-Thermorasp::Thermorasp(const string& address, quint16 port) {
-    _address = QString::fromStdString(address);
-    _port = port;
+Thermorasp::Thermorasp(const string& address, quint16 port)
+    : Thermorasp(QString::fromStdString(address), port) {
 }
 
 void Thermorasp::setSensorNames(const std::vector<std::string>& names) {
     _sensorNames = names;
+    _parserHeader.clear();
 }
 
 void Thermorasp::addSensorName(const std::string& name) {
     _sensorNames.push_back(name);
+    _parserHeader.clear();
 }
 
 std::vector<std::string> Thermorasp::getSensorNames() const {
     return _sensorNames;
 }
 
-QMap<QString, QString> Thermorasp::_parseReplyForReadings(QByteArray buffer) const {
-    QMap<QString, QString> ret;
-    QString data = QTextCodec::codecForMib(106)->toUnicode(buffer);
-    int nlpos = data.indexOf('\n');
-    if (nlpos < 1)
-        return ret;
-    QString nameline = data.mid(1, nlpos - 1);
-    QString readingsline = data.right(data.length() - (nlpos + 1));
-    QStringList names = nameline.split(' ');
+void Thermorasp::_compileParser(const QByteArray& header) {
+    QStringList names = QTextCodec::codecForMib(106)->toUnicode(header).split(' ');
     
     QString pattern("^");
     for (const QString& name: names) {
@@ -53,41 +61,177 @@ QMap<QString, QString> Thermorasp::_parseReplyForReadings(QByteArray buffer) con
             pattern += "([^ ]+)?"; // except anything
     }
     pattern += "$";
-    QRegularExpression re(pattern);
-    QRegularExpressionMatch match = re.match(readingsline);
+    _parserRegex.setPattern(pattern);
+    _parserRegex.optimize();
+    
+    _parserSensorColumns.fill(0, static_cast<int>(_sensorNames.size()));
+    for (size_t i = 0; i < _sensorNames.size(); ++i)
+        _parserSensorColumns[i] = names.indexOf(QString::fromStdString(_sensorNames[i])) + 1;
+    _parserHeader = header;
+}
+
+bool Thermorasp::_parseReadingsLine(const QByteArray& header, const QByteArray& line, ThermoraspReadings& readings) {
+    if (header != _parserHeader or _parserRegex.pattern().isEmpty())
+        _compileParser(header);
+    
+    QString readingsline = QTextCodec::codecForMib(106)->toUnicode(line);
+    QRegularExpressionMatch match = _parserRegex.match(readingsline);
     
     if (not match.hasMatch()) {
         qCritical("Raspberry sent line with invalid format: '%s'", readingsline.toLatin1().data());
-        return ret;
+        return false;
     }
     
-    for (int i = 0; i < names.length(); ++i)
-        ret[names[i]] = match.captured(i + 1);
-        
-    return ret;
+    readings.values.resize(_parserSensorColumns.size());
+    for (int i = 0; i < _parserSensorColumns.size(); ++i) {
+        bool ok = false;
+        double value = 0;
+        if (_parserSensorColumns[i] > 0)
+            value = match.capturedRef(_parserSensorColumns[i]).toDouble(&ok);
+        readings.values[i] = ok ? value : qQNaN();
+    }
+    
+    return true;
 }
 
-QMap<QString, QString> Thermorasp::getLastReadings() const {
+bool Thermorasp::_parseReplyForReadings(const QByteArray& buffer, ThermoraspReadings& readings) {
+    int nlpos = buffer.indexOf('\n');
+    if (nlpos < 1)
+        return false;
+    
+    // The first character of the header line is a comment sign
+    QByteArray header = buffer.mid(1, nlpos - 1);
+    QByteArray line = buffer.mid(nlpos + 1);
+    if (line.endsWith('\n'))
+        line.chop(1);
+    return _parseReadingsLine(header, line, readings);
+}
+
+ThermoraspReadings Thermorasp::getLastReadings() const {
+    QMutexLocker locker(&_readingsMutex);
     return _lastReadings;
 }
 
-QMap<QString, QString> Thermorasp::fetchReadings(int timeout) {
-    QTcpSocket* sock = new QTcpSocket(nullptr);
-    QMap<QString, QString> ret;
-    sock->connectToHost(_address, _port);
-    if (not sock->waitForDisconnected(timeout)) {
+void Thermorasp::setStreaming(bool streaming) {
+    _streaming = streaming;
+}
+
+bool Thermorasp::isStreaming() const {
+    return _streaming;
+}
+
+void Thermorasp::fetchReadings(int timeout) {
+    if (_sock == nullptr)
+        _createSocket();
+    
+    // A request is still running or, when streaming, the connection is
+    // up and readings arrive without asking
+    if (_sock->state() != QAbstractSocket::UnconnectedState)
+        return;
+    
+    if (_clock.elapsed() < _retryAt)
+        return;
+    
+    _buffer.clear();
+    _header.clear();
+    _timeoutTimer->start(timeout);
+    _sock->connectToHost(_address, _port);
+}
+
+void Thermorasp::_createSocket() {
+    // The socket and the timer belong to the calling thread. They get
+    // deleted when the thread finishes, as they can't be deleted from
+    // another one.
+    _sock = new QTcpSocket(nullptr);
+    _timeoutTimer = new QTimer(_sock);
+    _timeoutTimer->setSingleShot(true);
+    connect(QThread::currentThread(), &QThread::finished, _sock, &QObject::deleteLater);
+    connect(_sock, &QObject::destroyed, this, [this]() {
+        _sock = nullptr;
+        _timeoutTimer = nullptr;
+    }, Qt::DirectConnection);
+    
+    connect(_sock, &QTcpSocket::connected, _sock, [this]() {
+        // When streaming the connection may stay idle for a long time
+        if (_streaming)
+            _timeoutTimer->stop();
+    });
+    connect(_sock, &QTcpSocket::readyRead, _sock, [this]() {
+        _onReadyRead();
+    });
+    connect(_sock, &QTcpSocket::disconnected, _sock, [this]() {
+        _onDisconnected();
+    });
+    connect(_sock, static_cast<void (QAbstractSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error),
+            _sock, [this](QAbstractSocket::SocketError error) {
+        // The server closes the connection after sending the readings
+        if (error != QAbstractSocket::RemoteHostClosedError)
+            _onError();
+    });
+    connect(_timeoutTimer, &QTimer::timeout, _sock, [this]() {
         qInfo("Thermorasp at %s didn't answer", _address.toLatin1().data());
-        return ret;
+        _onError();
+    });
+}
+
+void Thermorasp::_onReadyRead() {
+    _buffer += _sock->readAll();
+    if (not _streaming)
+        return;
+    
+    int nlpos;
+    while ((nlpos = _buffer.indexOf('\n')) >= 0) {
+        QByteArray line = _buffer.left(nlpos);
+        _buffer.remove(0, nlpos + 1);
+        _processLine(line);
+    }
+}
+
+void Thermorasp::_onDisconnected() {
+    _timeoutTimer->stop();
+    if (_streaming) {
+        qWarning("Thermorasp at %s closed the connection", _address.toLatin1().data());
+        return;
     }
-    sock->waitForReadyRead(timeout);
     
-    QByteArray buffer = sock->readAll();
-    ret = _parseReplyForReadings(buffer);
+    if (not _buffer.isEmpty()) {
+        ThermoraspReadings readings;
+        if (_parseReplyForReadings(_buffer, readings))
+            _publishReadings(readings);
+        _buffer.clear();
+    }
+}
+
+void Thermorasp::_onError() {
+    _timeoutTimer->stop();
+    // Discard what was received so far, it won't be complete
+    _buffer.clear();
     
-    sock->close();
-    delete sock;
+    _backoff = std::min(std::max(2 * _backoff, BACKOFF_MIN), BACKOFF_MAX);
+    _retryAt = _clock.elapsed() + _backoff;
+    qWarning("Could not get readings from Thermorasp at %s: %s. Retrying in %d ms",
+        _address.toLatin1().data(), _sock->errorString().toLatin1().data(), _backoff);
+    
+    _sock->abort();
+}
+
+void Thermorasp::_processLine(const QByteArray& line) {
+    if (_header.isEmpty()) {
+        // The first character of the header line is a comment sign
+        _header = line.mid(1);
+        return;
+    }
     
-    _lastReadings = ret;
-    emit gotNewReadings(_lastReadings);
-    return ret;
+    ThermoraspReadings readings;
+    if (_parseReadingsLine(_header, line, readings))
+        _publishReadings(readings);
+}
+
+void Thermorasp::_publishReadings(const ThermoraspReadings& readings) {
+    _backoff = 0;
+    {
+        QMutexLocker locker(&_readingsMutex);
+        _lastReadings = readings;
+    }
+    emit gotNewReadings(readings);
 }
@@ -2,8 +2,12 @@
 #define THERMORASP_H
 
 #include <QObject>
-#include <QMap>
+#include <QMutex>
 #include <QString>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QMetaType>
+#include <QRegularExpression>
 #include <QtNetwork/QTcpSocket>
 
 #include <string>
@@ -11,8 +15,33 @@
 
 #include "devices/genericinstrumentclass.h"
 
+class QTimer;
+
 using namespace std;
 
+/**
+ * One set of readings of a Thermorasp
+ */
+struct ThermoraspReadings {
+    /**
+     * Temperatures in the order of Thermorasp::getSensorNames. NaN if
+     * the sensor is missing in the reply or its value isn't a number.
+     */
+    QVector<double> values;
+};
+
+Q_DECLARE_METATYPE(ThermoraspReadings)
+
+/**
+ * Client for the thermorasp server running on a Raspberry Pi. The
+ * server sends a line with the sensor names followed by lines with
+ * readings.
+ *
+ * All network communication is asynchronous. The socket is created on
+ * the thread that first calls fetchReadings and its event loop handles
+ * it from then on, so fetchReadings has to be called from the same
+ * thread every time.
+ */
 class Thermorasp : public GenericInstrumentClass {
     Q_OBJECT
 
@@ -23,20 +52,63 @@ public:
     void setSensorNames(const std::vector<std::string>& names);
     void addSensorName(const std::string& name);
     std::vector<std::string> getSensorNames() const;
-    QMap<QString, QString> getLastReadings() const;
-    QMap<QString, QString> fetchReadings(int timeout = 5000);
+    ThermoraspReadings getLastReadings() const;
+    
+    /**
+     * Request new readings. Returns immediately, gotNewReadings is
+     * emitted once they have arrived. Does nothing if a request is
+     * still running or if the Raspberry Pi couldn't be reached recently
+     * and the time to wait before the next attempt hasn't passed yet.
+     * @param timeout Time in ms after which a request gets aborted
+     */
+    void fetchReadings(int timeout = 5000);
+    
+    /**
+     * In streaming mode the connection is kept open and the server
+     * sends readings on its own. fetchReadings then only (re)connects
+     * if needed. Otherwise the server closes the connection after one
+     * line of readings and a new connection is made for every request.
+     */
+    void setStreaming(bool streaming);
+    bool isStreaming() const;
 
 signals:
-    void gotNewReadings(QMap<QString, QString> readings) const;
+    void gotNewReadings(ThermoraspReadings readings) const;
 
 public slots:
 private:
     quint16 _port;
     QString _address;
     std::vector<std::string> _sensorNames;
-    QMap<QString, QString> _lastReadings;
+    ThermoraspReadings _lastReadings;
+    mutable QMutex _readingsMutex;
+    bool _streaming;
+    
+    QTcpSocket* _sock;
+    QTimer* _timeoutTimer;
+    QByteArray _buffer;
+    QByteArray _header;
+    
+    // Waiting time before the next connection attempt after a failure
+    QElapsedTimer _clock;
+    qint64 _retryAt;
+    int _backoff;
+    
+    void _createSocket();
+    void _onReadyRead();
+    void _onDisconnected();
+    void _onError();
+    void _processLine(const QByteArray& line);
+    void _publishReadings(const ThermoraspReadings& readings);
+    bool _parseReplyForReadings(const QByteArray& buffer, ThermoraspReadings& readings);
+    bool _parseReadingsLine(const QByteArray& header, const QByteArray& line, ThermoraspReadings& readings);
+    void _compileParser(const QByteArray& header);
     
-    QMap<QString, QString> _parseReplyForReadings(QByteArray buffer) const;
+    // Parser for the header line seen last. The server sends the same
+    // header every time, so it only gets compiled once.
+    QByteArray _parserHeader;
+    QRegularExpression _parserRegex;
+    QVector<int> _parserSensorColumns; // Capture group of each sensor, 0 if missing
 };
 
 #endif // THERMORASP_H
@@ -1,6 +1,90 @@
 #include "genericinstrumentclass.h"
+#include "general/BurnInException.h"
+
+#include <exception>
 
 GenericInstrumentClass::GenericInstrumentClass()
 {
+    _context = new DeviceContext();
+    _connected = true;
+}
+
+GenericInstrumentClass::~GenericInstrumentClass() {
+    delete _context;
+}
+
+CommunicationStats GenericInstrumentClass::getStats() const {
+    return CommunicationStats();
+}
+
+DeviceContext* GenericInstrumentClass::getContext() const {
+    return _context;
+}
+
+void GenericInstrumentClass::supervise(const std::function<void()>& poll) {
+    Communicator* comm = _getCommunicator();
+    if (comm == nullptr) {
+        poll();
+        return;
+    }
+    
+    // A lost device doesn't take time from the polls until it is back
+    if (not _supervisor.isConnected()) {
+        if (not _supervisor.tryReconnect(comm, _context->getName()))
+            return;
+        try {
+            _restoreState();
+        } catch (const std::exception& e) {
+            qWarning("Could not restore the settings of %s: %s", _context->getName().c_str(), e.what());
+            _supervisor.markLost();
+            return;
+        }
+        _connected = true;
+        emit connectionStateChanged(true);
+    }
+    
+    bool lost;
+    try {
+        poll();
+        lost = _supervisor.update(comm, _context->getName());
+    } catch (...) {
+        // Errors are only worth reporting while the device is there. Not
+        // only BurnInException, e.g. parsing the empty answer of a read
+        // that timed out fails as well
+        lost = _supervisor.update(comm, _context->getName());
+        if (not lost)
+            throw;
+    }
+    if (lost) {
+        _connected = false;
+        emit connectionStateChanged(false);
+    }
+}
+
+bool GenericInstrumentClass::isConnected() const {
+    return _connected;
+}
+
+ChangeFilter* GenericInstrumentClass::getChangeFilter() {
+    return &_changes;
+}
+
+bool GenericInstrumentClass::_reportChange(const std::string& quantity, int output, double value) const {
+    bool reported = _changes.update(quantity, output, value);
+    emit readingTaken(quantity, output, value, reported);
+    return reported;
+}
+
+bool GenericInstrumentClass::_reportState(const std::string& quantity, int output, double value) const {
+    bool reported = _changes.updateState(quantity, output, value);
+    emit readingTaken(quantity, output, value, reported);
+    return reported;
+}
+
+Communicator* GenericInstrumentClass::_getCommunicator() const {
+    return nullptr;
+}
 
+void GenericInstrumentClass::_restoreState() {
+    
 }
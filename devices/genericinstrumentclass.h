@@ -2,8 +2,15 @@
 #define GENERICINSTRUMENTCLASS_H
 
 #include <QObject>
+#include <atomic>
+#include <functional>
 #include <string>
 
+#include "devices/communication/communicator.h"
+#include "devices/communication/connectionsupervisor.h"
+#include "devices/changefilter.h"
+#include "devices/devicecontext.h"
+
 using namespace std;
 
 class GenericInstrumentClass: public QObject
@@ -12,12 +19,91 @@ class GenericInstrumentClass: public QObject
 public:
     GenericInstrumentClass();
     
-    virtual ~GenericInstrumentClass() {
-    
-    };
+    virtual ~GenericInstrumentClass();
 
     virtual void initialize() = 0;
+    
+    /**
+     * @return Counters of the communication with the device. All zero
+     * if the device isn't connected or doesn't count
+     */
+    virtual CommunicationStats getStats() const;
+    
+    /**
+     * @return Context all operations talking to the device run on. Use
+     * post for setters from the GUI, call where the result is needed
+     */
+    DeviceContext* getContext() const;
+    
+    /**
+     * Poll the device unless its connection is lost. While it is lost,
+     * reconnect with exponential backoff instead and restore the
+     * settings of the device once it is back. Must be called on the
+     * thread of the context.
+     * @param poll Function querying the device
+     */
+    void supervise(const std::function<void()>& poll);
+    
+    /**
+     * @return false while the connection to the device is lost. Can be
+     * called from any thread
+     */
+    bool isConnected() const;
+    
+    /**
+     * @return Filter deciding which readings are emitted. Set it up
+     * before the device is initialized
+     */
+    ChangeFilter* getChangeFilter();
+
+signals:
+    /**
+     * Emitted on the thread of the context when the connection is lost
+     * or back
+     */
+    void connectionStateChanged(bool connected);
+    
+    /**
+     * Emitted for every reading passed through _reportChange or
+     * _reportState, also for those the change filter held back
+     * @param reported Whether the change filter let it through
+     */
+    void readingTaken(const std::string& quantity, int output, double value, bool reported) const;
+
+protected:
+    /**
+     * @return The communicator whose connection is supervised, nullptr
+     * if the device has none or isn't initialized
+     */
+    virtual Communicator* _getCommunicator() const;
+    
+    /**
+     * Send the settings cached by the driver to the device again after
+     * reconnecting. Does nothing by default
+     */
+    virtual void _restoreState();
+    
+    /**
+     * Pass a reading through the change filter
+     * @param quantity Name of the quantity as in the channels of the hub,
+     * e.g. "voltage"
+     * @param output Output of a voltage source, 0 for other devices
+     * @return true if the reading should be emitted
+     */
+    bool _reportChange(const std::string& quantity, int output, double value) const;
+    
+    /**
+     * Like _reportChange for states and settings, e.g. whether a
+     * circulator is on. Every change is reported
+     */
+    bool _reportState(const std::string& quantity, int output, double value) const;
 
+private:
+    DeviceContext* _context;
+    ConnectionSupervisor _supervisor;
+    std::atomic<bool> _connected;
+    // Getters of some drivers emit, so they are const
+    mutable ChangeFilter _changes;
 
 };
 
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <string>
 #include <cstdlib>
+#include <cstdio>
 #include <utility>
 #include <cmath>
 
@@ -10,14 +11,16 @@
 #include <QEventLoop>
 
 #include "controlkeithleypower.h"
+#include "devices/communication/serialcommunicator.h"
 #include "general/BurnInException.h"
 #include "general/systemcontrollerclass.h"
 
 using namespace std;
 
-const int SWEEP_INTERVAL = 500; //ms
-const double SWEEP_STEP = 10; //V
+const int SWEEP_INTERVAL = ControlKeithleyPower::SWEEP_INTERVAL;
+const double SWEEP_STEP = ControlKeithleyPower::SWEEP_STEP;
 const double SWEEP_EPSILON = 0.00001; //V
+const int SHUTDOWN_MARGIN = 10000; //ms, added to the time ramping down takes
 
 KeithleyPowerSweepWorker::KeithleyPowerSweepWorker(ControlKeithleyPower* keithley):
     _keithley(keithley),
@@ -33,6 +36,13 @@ KeithleyPowerSweepWorker::KeithleyPowerSweepWorker(ControlKeithleyPower* keithle
 }
 
 void KeithleyPowerSweepWorker::doSweeping() {
+    // Continues from what the device reports once it is back. Nothing
+    // can be sent to it until then, so it doesn't hold up quitting
+    if (not _keithley->isConnected()) {
+	if (not _outputStateTarget)
+	    emit shutdownSafe();
+	return;
+    }
     if (not _outputStateTarget and not _outputStateApplied) {
 	emit shutdownSafe();
 	return;
@@ -74,7 +84,7 @@ void KeithleyPowerSweepWorker::doDeviceStateChanged(bool state, double volt) {
 
 ControlKeithleyPower::ControlKeithleyPower(string pConnection, double pSetVolt, double pSetCurr)
 {
-    comHandler_ = nullptr;
+    _comm = nullptr;
     fConnection = pConnection;
     fVoltSet = pSetVolt;
     fCurrCompliance = pSetCurr;
@@ -82,46 +92,44 @@ ControlKeithleyPower::ControlKeithleyPower(string pConnection, double pSetVolt,
     fCurr = 0;
     _outputOn = false;
     
+    // Sweeps on the thread of the context, so that the sweep steps are
+    // queued with the other operations of the device
     _worker = new KeithleyPowerSweepWorker(this);
-    _worker->moveToThread(&_sweepThread);
-    connect(&_sweepThread, &QThread::finished, _worker, &QObject::deleteLater);
+    _worker->moveToThread(getContext()->getThread());
+    connect(getContext()->getThread(), &QThread::finished, _worker, &QObject::deleteLater);
     connect(this, &ControlKeithleyPower::voltSetChanged, _worker, &KeithleyPowerSweepWorker::doVoltSet);
     connect(this, &ControlKeithleyPower::powerStateChanged, _worker, &KeithleyPowerSweepWorker::doOutputState);
     connect(this, &ControlKeithleyPower::deviceStateChanged, _worker, &KeithleyPowerSweepWorker::doDeviceStateChanged);
-    _sweepThread.start();
 }
 
 ControlKeithleyPower::~ControlKeithleyPower() {
-    _sweepThread.quit();
-    _sweepThread.wait();
+    // The worker sweeps until the thread is stopped
+    getContext()->stop();
+    if (_comm != nullptr)
+        delete _comm;
 }
 
 void ControlKeithleyPower::initialize(){
     
-    Q_ASSERT(comHandler_ == nullptr);
-    comHandler_ = new ComHandler(fConnection.c_str(), B19200);
+    Q_ASSERT(_comm == nullptr);
+    _comm = new SerialCommunicator(fConnection, B19200);
+    _comm->setSuffix("\n");
+    // A measurement (:READ?) takes several hundred ms
+    _comm->timeout = 2000;
+    _comm->open();
     _outputOn = false;
     
-    char buf[1024];
-    memset(buf, 0, sizeof(buf));
-    _commMutex.lock();
-    comHandler_->SendCommand("*IDN?");
-    comHandler_->ReceiveString(buf);
-    _commMutex.unlock();
-    if (memcmp(buf, "KEITHLEY INSTRUMENTS INC.,MODEL 2410", 36) != 0)
+    std::string idn = _comm->query("*IDN?");
+    if (idn.compare(0, 36, "KEITHLEY INSTRUMENTS INC.,MODEL 2410") != 0)
 	throw BurnInException("Invalid or no device at address of Keithley 2410");
     
     setCurr(fCurrCompliance);
     setVolt(fVoltSet);
     
     // check whether output is on
-    _commMutex.lock();
-    comHandler_->SendCommand(":OUTPUT1:STATE?");
-    usleep(1000);
-    comHandler_->ReceiveString(buf);
-    _commMutex.unlock();
+    std::string state = _comm->query(":OUTPUT1:STATE?");
     
-    if (buf[0] == '1') {
+    if (state.length() > 0 and state[0] == '1') {
 	qInfo("Keithley output was on during initialization. Turning off");
 	refreshAppliedValues();
 	emit deviceStateChanged(true, fVolt);
@@ -153,41 +161,35 @@ void ControlKeithleyPower::setVolt(double pVoltage , int)
 void ControlKeithleyPower::sendVoltageCommand(double pVoltage) {
     char buf[512];
     sprintf(buf ,":SOUR:VOLT:LEV %G", pVoltage);
-    _commMutex.lock();
-    comHandler_->SendCommand(buf);
+    _comm->send(buf);
     QThread::msleep(100);
-    _commMutex.unlock();
 }
 
 void ControlKeithleyPower::sendOutputStateCommand(bool on) {
-    _commMutex.lock();
     if (on) {
-	comHandler_->SendCommand(":*RST");
+	_comm->send(":*RST");
 	QThread::usleep(1000);
 	
-	comHandler_->SendCommand(":OUTPUT1:STATE ON");
+	_comm->send(":OUTPUT1:STATE ON");
 	QThread::usleep(1000);
 
-	comHandler_->SendCommand(":SOURCE:VOLTAGE:RANGE 1000");
+	_comm->send(":SOURCE:VOLTAGE:RANGE 1000");
 	QThread::usleep(1000);
 	
-	comHandler_->SendCommand(":SENSE:FUNCTION 'CURRENT:DC'");
+	_comm->send(":SENSE:FUNCTION 'CURRENT:DC'");
 	QThread::usleep(1000);
     } else {
-	comHandler_->SendCommand(":OUTPUT1:STATE OFF");
+	_comm->send(":OUTPUT1:STATE OFF");
 	QThread::msleep(1000);
     }
-    _commMutex.unlock();
 }
 
 void ControlKeithleyPower::setCurr(double pCurrent, int)
 {
     char stringinput[512];
     
-    _commMutex.lock();
     sprintf(stringinput ,":SENS:CURR:PROT %lGE-6" , pCurrent);
-    comHandler_->SendCommand(stringinput);
-    _commMutex.unlock();
+    _comm->send(stringinput);
     fCurrCompliance = pCurrent;
     emit currSetChanged(fCurrCompliance, 1);
 }
@@ -211,42 +213,29 @@ double ControlKeithleyPower::getCurrApp(int) const {
 void ControlKeithleyPower::refreshAppliedValues()
 {
     if (not _outputOn) {
-	if (fVolt != 0) {
-	    fVolt = 0;
+	fVolt = 0;
+	fCurr = 0;
+	if (_reportChange("voltage", 1, fVolt))
 	    emit voltAppChanged(fVolt, 1);
-	}
-	if (fCurr != 0) {
-	    fCurr = 0;
-	    emit voltAppChanged(fCurr, 1);
-	}
+	if (_reportChange("current", 1, fCurr))
+	    emit currAppChanged(fCurr, 1);
 	return;
     }
-    char buffer[1024];
-    buffer[0] = 0;
-
-    _commMutex.lock();
-    comHandler_->SendCommand(":READ?");
-    QThread::msleep(500);
-
-    comHandler_->ReceiveString(buffer);
-    _commMutex.unlock();
+    // Returns as soon as the measurement arrived
+    string str = _comm->query(":READ?");
     
-    string str(buffer);
     size_t cPos = str.find(',');
 
     QString fVoltStr = QString::fromStdString(str.substr(0 , cPos));
     str = str.substr(cPos+1, cPos + 13);
     QString fCurrStr = QString::fromStdString(str.substr(0 , 13));
 
-    bool voltchanged = fVolt != fVoltStr.toDouble();
-    bool currchanged = fCurr != fCurrStr.toDouble();
-
     fVolt = fVoltStr.toDouble();
     fCurr = fCurrStr.toDouble();
 
-    if (voltchanged)
+    if (_reportChange("voltage", 1, fVolt))
 	emit voltAppChanged(fVolt, 1);
-    if (currchanged)
+    if (_reportChange("current", 1, fCurr))
 	emit currAppChanged(fCurr, 1);
 }
 
@@ -257,7 +246,42 @@ void ControlKeithleyPower::closeConnection()
 
 void ControlKeithleyPower::waitForSafeShutdown() {
     Q_ASSERT(_outputOn == false);
+    if (not isConnected()) {
+        qWarning("Keithley is not connected. Can't ramp down its voltage");
+        return;
+    }
+    
+    // Enough to ramp down from the last reading, in case the device
+    // stops answering while ramping
+    int timeout = static_cast<int>(std::ceil(std::abs(fVolt) / SWEEP_STEP)) * SWEEP_INTERVAL + SHUTDOWN_MARGIN;
     QEventLoop loop;
+    QTimer timer;
+    timer.setSingleShot(true);
     connect(_worker, SIGNAL(shutdownSafe()), &loop, SLOT(quit()));
+    connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
+    timer.start(timeout);
     loop.exec();
+    if (not timer.isActive())
+        qWarning("Keithley didn't finish ramping down within %d ms", timeout);
+}
+
+Communicator* ControlKeithleyPower::_getCommunicator() const {
+    return _comm;
+}
+
+void ControlKeithleyPower::_restoreState() {
+    setCurr(fCurrCompliance);
+    
+    // The device might have been switched off in the meantime
+    std::string state = _comm->query(":OUTPUT1:STATE?");
+    if (state.length() > 0 and state[0] == '1')
+        emit deviceStateChanged(true, fVolt);
+    else
+        emit deviceStateChanged(false, 0);
+}
+
+CommunicationStats ControlKeithleyPower::getStats() const {
+    if (_comm == nullptr)
+        return CommunicationStats();
+    return _comm->getStats();
 }
@@ -3,11 +3,10 @@
 
 #include <QObject>
 #include <QThread>
-#include <QMutex>
 #include <QTimer>
 
 #include "devices/power/powercontrolclass.h"
-#include "devices/ComHandler.h"
+#include "devices/communication/communicator.h"
 
 class ControlKeithleyPower;
 
@@ -57,9 +56,28 @@ public:
     void offPower(int = 0) override;
     void closeConnection() override;
     void refreshAppliedValues() override;
+    CommunicationStats getStats() const override;
     /* End of implementation of pure virtual functions */
     
+    /**
+     * Wait until the output was ramped down and turned off. Returns at
+     * once if the device is not connected and gives up after the time
+     * ramping down should take
+     */
     void waitForSafeShutdown();
+    
+    // The voltage is changed by at most SWEEP_STEP every SWEEP_INTERVAL
+    static constexpr int SWEEP_INTERVAL = 500; //ms
+    static constexpr double SWEEP_STEP = 10; //V
+
+protected:
+    Communicator* _getCommunicator() const override;
+    
+    /**
+     * Set the compliance again and let the worker sweep to the set
+     * voltage from what the device has now
+     */
+    void _restoreState() override;
 
 private:
     friend class KeithleyPowerSweepWorker;
@@ -76,13 +94,11 @@ private:
     double fCurrCompliance;
     string fConnection;
 
-    ComHandler* comHandler_;
-    QMutex _commMutex;
+    Communicator* _comm;
 
     bool _outputOn;
 
     KeithleyPowerSweepWorker* _worker;
-    QThread _sweepThread;
     
 signals:
     void deviceStateChanged(bool on, double volt);
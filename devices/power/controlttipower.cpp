@@ -4,6 +4,8 @@
 #include <QDebug>
 
 #include <string>
+#include <vector>
+#include <stdexcept>
 #include <iostream>
 
 #include "general/BurnInException.h"
@@ -150,27 +152,38 @@ double ControlTTiPower::getCurrApp(int pId) const {
 void ControlTTiPower::refreshAppliedValues() {
     double voltapp0, currapp0, voltapp1, currapp1;
     try {
-        voltapp0 = std::stof(_comm->query("V2?").substr(3));
-        currapp0 = std::stof(_comm->query("I2?").substr(3));
-        voltapp1 = std::stof(_comm->query("V1?").substr(3));
-        currapp1 = std::stof(_comm->query("I1?").substr(3));
-    } catch (std::invalid_argument& e) {
+        // One round trip for all four values
+        std::vector<std::string> answers = _comm->queryBatch({"V2?", "I2?", "V1?", "I1?"});
+        if (answers.size() != 4)
+            throw std::invalid_argument("Wrong number of answers");
+        voltapp0 = std::stof(answers[0].substr(3));
+        currapp0 = std::stof(answers[1].substr(3));
+        voltapp1 = std::stof(answers[2].substr(3));
+        currapp1 = std::stof(answers[3].substr(3));
+    } catch (std::logic_error& e) {
         qCritical("Invalid response from TTi at %s", _comm->getLocDisplay().c_str());
         return;
     }
-    _setAndEmitIfChanged(&(_voltApp[0]), voltapp0, 1, &ControlTTiPower::voltAppChanged);
-    _setAndEmitIfChanged(&(_currApp[0]), currapp0, 1, &ControlTTiPower::currAppChanged);
-    _setAndEmitIfChanged(&(_voltApp[1]), voltapp1, 2, &ControlTTiPower::voltAppChanged);
-    _setAndEmitIfChanged(&(_currApp[1]), currapp1, 2, &ControlTTiPower::currAppChanged);
-}
-
-void ControlTTiPower::_setAndEmitIfChanged(double* target, double val, int id, void (ControlTTiPower::*signal)(double, int)) {
-    bool changed = *target != val;
-    *target = val;
-    if (changed)
-        emit (this->*signal)(val, id);
+    _voltApp[0] = voltapp0;
+    _currApp[0] = currapp0;
+    _voltApp[1] = voltapp1;
+    _currApp[1] = currapp1;
+    for (int i = 1; i <= 2; ++i) {
+        if (_reportChange("voltage", i, _voltApp[i - 1]))
+            emit voltAppChanged(_voltApp[i - 1], i);
+        if (_reportChange("current", i, _currApp[i - 1]))
+            emit currAppChanged(_currApp[i - 1], i);
+    }
 }
 
 void ControlTTiPower::closeConnection() {
     _comm->close();
 }
+
+Communicator* ControlTTiPower::_getCommunicator() const {
+    return _comm;
+}
+
+CommunicationStats ControlTTiPower::getStats() const {
+    return _comm->getStats();
+}
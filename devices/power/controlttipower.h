@@ -26,8 +26,12 @@ public:
     void offPower(int pId) override;
     void closeConnection() override;
     void refreshAppliedValues() override;
+    CommunicationStats getStats() const override;
     /* End of implementation of pure virtual functions */
 
+protected:
+    Communicator* _getCommunicator() const override;
+    
 private:
     Communicator* _comm;
     
@@ -39,6 +43,5 @@ private:
     double _currApp[2];
     
     void _refreshPowerStatus(int pId);
-    void _setAndEmitIfChanged(double* target, double val, int id, void (ControlTTiPower::*signal)(double, int));
 };
 #endif // CONTROLTTIPOWER_H
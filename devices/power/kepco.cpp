@@ -1,6 +1,10 @@
 #include "kepco.h"
 #include "general/BurnInException.h"
 
+#include <string>
+#include <vector>
+#include <stdexcept>
+
 Kepco::Kepco(Communicator* comm) {
     _comm = comm;
     _comm->setSuffix("\n");
@@ -78,19 +82,28 @@ void Kepco::closeConnection() {
 void Kepco::refreshAppliedValues() {
     double voltapp, currapp;
     try {
-        voltapp = std::stof(_comm->query("MEAS:VOLT?"));
-        currapp = std::stof(_comm->query("MEAS:CURR?"));
-    } catch (std::invalid_argument& e) {
+        // The colon resets the SCPI command tree for the second query
+        std::vector<std::string> answers = _comm->queryBatch({"MEAS:VOLT?", ":MEAS:CURR?"});
+        if (answers.size() != 2)
+            throw std::invalid_argument("Wrong number of answers");
+        voltapp = std::stof(answers[0]);
+        currapp = std::stof(answers[1]);
+    } catch (std::logic_error& e) {
         qCritical("Invalid response from Kepco at %s", _comm->getLocDisplay().c_str());
         return;
     }
-    _setAndEmitIfChanged(&_voltApp, voltapp, &Kepco::voltAppChanged);
-    _setAndEmitIfChanged(&_currApp, currapp, &Kepco::voltAppChanged);
+    _voltApp = voltapp;
+    _currApp = currapp;
+    if (_reportChange("voltage", 1, _voltApp))
+        emit voltAppChanged(_voltApp, 1);
+    if (_reportChange("current", 1, _currApp))
+        emit currAppChanged(_currApp, 1);
+}
+
+Communicator* Kepco::_getCommunicator() const {
+    return _comm;
 }
 
-void Kepco::_setAndEmitIfChanged(double* target, double val, void (Kepco::*signal)(double, int)) {
-    bool changed = *target != val;
-    *target = val;
-    if (changed)
-        emit (this->*signal)(val, 1);
+CommunicationStats Kepco::getStats() const {
+    return _comm->getStats();
 }
@@ -25,10 +25,12 @@ public:
     void offPower(int = 0) override;
     void closeConnection() override;
     void refreshAppliedValues() override;
+    CommunicationStats getStats() const override;
+    
+protected:
+    Communicator* _getCommunicator() const override;
     
 private:
-    void _setAndEmitIfChanged(double* target, double val, void (Kepco::*signal)(double, int));
-
     Communicator* _comm;
     
     bool _outputOn;
@@ -4,3 +4,14 @@ using namespace std;
 
 PowerControlClass::PowerControlClass()
 {}
+
+void PowerControlClass::_restoreState() {
+    for (int i = 1; i <= getNumOutputs(); ++i) {
+        setVolt(getVolt(i), i);
+        setCurr(getCurr(i), i);
+        if (getPower(i))
+            onPower(i);
+        else
+            offPower(i);
+    }
+}
@@ -104,6 +104,13 @@ public:
      */
     virtual void closeConnection() = 0;
     
+protected:
+    /**
+     * Set the voltages, currents and output states the getters return
+     * again
+     */
+    void _restoreState() override;
+
 signals:
     void voltSetChanged(double volt, int id);
     void currSetChanged(double curr, int id);
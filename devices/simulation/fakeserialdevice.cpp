@@ -0,0 +1,127 @@
+#include "fakeserialdevice.h"
+
+#include "general/BurnInException.h"
+
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+FakeSerialDevice::FakeSerialDevice(InstrumentSimulator* simulator, int latency, int jitter)
+    : _latency(latency, jitter)
+{
+    _simulator = simulator;
+    _master = -1;
+    _slave = -1;
+    _notifier = nullptr;
+    _lastAnswer = 0;
+    moveToThread(&_thread);
+
+    connect(&_thread, &QThread::started, this, &FakeSerialDevice::_begin);
+
+    // The notifier belongs to the thread and has to be deleted on it
+    connect(&_thread, &QThread::finished, this, [this]() {
+        delete _notifier;
+        _notifier = nullptr;
+    }, Qt::DirectConnection);
+}
+
+FakeSerialDevice::~FakeSerialDevice() {
+    stop();
+    if (_slave != -1)
+        ::close(_slave);
+    if (_master != -1)
+        ::close(_master);
+    delete _simulator;
+}
+
+void FakeSerialDevice::start() {
+    Q_ASSERT(not _thread.isRunning());
+
+    if (_master == -1) {
+        _master = posix_openpt(O_RDWR | O_NOCTTY);
+        char name[64];
+        if (_master == -1 or grantpt(_master) != 0 or unlockpt(_master) != 0
+                or ptsname_r(_master, name, sizeof(name)) != 0) {
+            qCritical("Could not create pseudo terminal: %s", std::strerror(errno));
+            throw BurnInException("Could not create pseudo terminal for simulated device");
+        }
+        _portName = name;
+        fcntl(_master, F_SETFL, O_NONBLOCK);
+
+        // Nothing is echoed until the driver configured the terminal
+        _slave = ::open(name, O_RDWR | O_NOCTTY);
+        if (_slave == -1)
+            throw BurnInException("Could not open pseudo terminal " + _portName);
+        termios settings;
+        tcgetattr(_slave, &settings);
+        cfmakeraw(&settings);
+        tcsetattr(_slave, TCSANOW, &settings);
+    }
+
+    _clock.start();
+    _lastAnswer = 0;
+    _thread.start();
+}
+
+void FakeSerialDevice::stop() {
+    _thread.quit();
+    _thread.wait();
+}
+
+std::string FakeSerialDevice::getPortName() const {
+    return _portName;
+}
+
+void FakeSerialDevice::_begin() {
+    _notifier = new QSocketNotifier(_master, QSocketNotifier::Read);
+    connect(_notifier, &QSocketNotifier::activated, this, &FakeSerialDevice::_onReadable);
+}
+
+void FakeSerialDevice::_onReadable() {
+    char buf[256];
+    ssize_t len;
+    while ((len = read(_master, buf, sizeof(buf))) > 0)
+        _buffer.append(buf, static_cast<int>(len));
+
+    int nlpos;
+    while ((nlpos = _buffer.indexOf('\n')) >= 0) {
+        QByteArray line = _buffer.left(nlpos);
+        _buffer.remove(0, nlpos + 1);
+        // The terminal turns line feeds into CR LF
+        if (line.endsWith('\r'))
+            line.chop(1);
+
+        std::string answer = _simulator->respond(line.toStdString());
+        if (answer.empty())
+            continue;
+
+        // A device answers one command after the other
+        qint64 now = _clock.elapsed();
+        _lastAnswer = std::max(now + _latency.next(), _lastAnswer);
+        QTimer::singleShot(static_cast<int>(_lastAnswer - now), this, [this, answer]() {
+            _write(answer);
+        });
+    }
+}
+
+void FakeSerialDevice::_write(const std::string& answer) {
+    std::string data = answer + "\n";
+    size_t written = 0;
+    while (written < data.length()) {
+        ssize_t n = write(_master, data.c_str() + written, data.length() - written);
+        if (n > 0)
+            written += n;
+        else if (n == -1 and errno != EINTR and errno != EAGAIN) {
+            qWarning("Simulated device %s could not answer: %s", _portName.c_str(), std::strerror(errno));
+            return;
+        }
+    }
+}
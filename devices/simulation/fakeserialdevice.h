@@ -0,0 +1,77 @@
+#ifndef FAKESERIALDEVICE_H
+#define FAKESERIALDEVICE_H
+
+#include <QObject>
+#include <QThread>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#include <string>
+
+#include "devices/simulation/instrumentsimulator.h"
+
+class QSocketNotifier;
+
+/**
+ * A simulated device behind a pseudo terminal. Drivers using a
+ * SerialCommunicator open the terminal given by getPortName instead of
+ * a serial port and don't notice the difference.
+ *
+ * Every line received is handed to the simulator and its answer is
+ * written back after the latency. Answers are sent in the order of the
+ * commands.
+ */
+class FakeSerialDevice : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param simulator The device. Gets deleted with the fake device
+     * @param latency Time in ms until an answer is sent
+     * @param jitter Maximum deviation from latency in ms
+     */
+    FakeSerialDevice(InstrumentSimulator* simulator, int latency = 0, int jitter = 0);
+    virtual ~FakeSerialDevice();
+
+    FakeSerialDevice(const FakeSerialDevice& other) = delete;
+    FakeSerialDevice& operator=(const FakeSerialDevice& other) = delete;
+
+    /**
+     * Create the pseudo terminal and start answering in a separate
+     * thread
+     */
+    void start();
+
+    /**
+     * Stop answering. The terminal stays open until the fake device is
+     * deleted.
+     */
+    void stop();
+
+    /**
+     * @return Device file of the terminal, e.g. /dev/pts/3
+     */
+    std::string getPortName() const;
+
+private slots:
+    void _begin();
+    void _onReadable();
+
+private:
+    void _write(const std::string& answer);
+
+    InstrumentSimulator* _simulator;
+    SimulatedLatency _latency;
+    int _master;
+    int _slave; // Kept open, so the terminal persists if the driver closes it
+    std::string _portName;
+
+    QByteArray _buffer;
+    QSocketNotifier* _notifier;
+    QElapsedTimer _clock;
+    qint64 _lastAnswer; // ms on _clock when the last answer is sent
+    QThread _thread;
+};
+
+#endif // FAKESERIALDEVICE_H
@@ -0,0 +1,98 @@
+#include "fakethermoraspserver.h"
+
+#include "general/BurnInException.h"
+
+#include <QDateTime>
+#include <QTimer>
+#include <QtGlobal>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+FakeThermoraspServer::FakeThermoraspServer(const std::vector<std::string>& sensorNames, int interval, int latency, int jitter)
+    : _latency(latency, jitter), _random(std::random_device()())
+{
+    _sensorNames = sensorNames;
+    _interval = interval;
+    _server = nullptr;
+    _port = 0;
+    moveToThread(&_thread);
+
+    // The server and its connections belong to the thread and have to
+    // be deleted on it
+    connect(&_thread, &QThread::finished, this, [this]() {
+        delete _server;
+        _server = nullptr;
+    }, Qt::DirectConnection);
+}
+
+FakeThermoraspServer::~FakeThermoraspServer() {
+    stop();
+}
+
+void FakeThermoraspServer::start() {
+    Q_ASSERT(not _thread.isRunning());
+    _thread.start();
+    QMetaObject::invokeMethod(this, "_listen", Qt::BlockingQueuedConnection);
+    if (_port == 0) {
+        stop();
+        throw BurnInException("Could not start simulated Thermorasp server");
+    }
+}
+
+void FakeThermoraspServer::stop() {
+    _thread.quit();
+    _thread.wait();
+}
+
+quint16 FakeThermoraspServer::getPort() const {
+    return _port;
+}
+
+void FakeThermoraspServer::_listen() {
+    _server = new QTcpServer();
+    connect(_server, &QTcpServer::newConnection, this, &FakeThermoraspServer::_onNewConnection);
+    // Keep the port when restarted, the Thermorasp connects to it
+    if (_server->listen(QHostAddress::LocalHost, _port))
+        _port = _server->serverPort();
+    else {
+        qCritical("Simulated Thermorasp server could not listen: %s", _server->errorString().toLatin1().data());
+        _port = 0;
+    }
+}
+
+void FakeThermoraspServer::_onNewConnection() {
+    while (_server->hasPendingConnections()) {
+        QTcpSocket* sock = _server->nextPendingConnection();
+        connect(sock, &QTcpSocket::disconnected, sock, &QObject::deleteLater);
+
+        QTimer::singleShot(_latency.next(), sock, [this, sock]() {
+            // The first character of the header line is a comment sign
+            QByteArray header("#date time");
+            for (const auto& name: _sensorNames)
+                header += " " + QByteArray::fromStdString(name);
+            sock->write(header + "\n");
+            sock->write(_readingsLine());
+
+            if (_interval <= 0) {
+                sock->disconnectFromHost();
+                return;
+            }
+            QTimer* timer = new QTimer(sock);
+            connect(timer, &QTimer::timeout, sock, [this, sock]() {
+                sock->write(_readingsLine());
+            });
+            timer->start(_interval);
+        });
+    }
+}
+
+QByteArray FakeThermoraspServer::_readingsLine() {
+    // Slowly rising values with some noise, one degree apart per sensor
+    std::normal_distribution<double> noise(0, 0.05);
+    double base = 20 + QDateTime::currentMSecsSinceEpoch() % 60000 / 60000.;
+
+    QByteArray line = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz").toLatin1();
+    for (size_t i = 0; i < _sensorNames.size(); ++i)
+        line += " " + QByteArray::number(base + i + noise(_random), 'f', 2);
+    return line + "\n";
+}
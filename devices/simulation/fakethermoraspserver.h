@@ -0,0 +1,74 @@
+#ifndef FAKETHERMORASPSERVER_H
+#define FAKETHERMORASPSERVER_H
+
+#include <QObject>
+#include <QThread>
+#include <QByteArray>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "devices/simulation/instrumentsimulator.h"
+
+class QTcpServer;
+
+/**
+ * Stands in for the thermorasp server of a Raspberry Pi. Listens on
+ * the local host and sends the header line and readings of the sensors
+ * like the real server: either one line of readings per connection or,
+ * when streaming, a line at a fixed interval until the client
+ * disconnects.
+ */
+class FakeThermoraspServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param sensorNames Names of the sensors to send readings for
+     * @param interval Time in ms between two lines of readings. 0 to
+     * close the connection after the first one
+     * @param latency Time in ms until a client gets the first line
+     * @param jitter Maximum deviation from latency in ms
+     */
+    FakeThermoraspServer(const std::vector<std::string>& sensorNames, int interval = 0, int latency = 0, int jitter = 0);
+    virtual ~FakeThermoraspServer();
+
+    FakeThermoraspServer(const FakeThermoraspServer& other) = delete;
+    FakeThermoraspServer& operator=(const FakeThermoraspServer& other) = delete;
+
+    /**
+     * Start listening in a separate thread. Returns once the server
+     * accepts connections.
+     */
+    void start();
+
+    /**
+     * Stop listening and close all connections
+     */
+    void stop();
+
+    /**
+     * @return Port the server listens on, chosen by the system
+     */
+    quint16 getPort() const;
+
+private slots:
+    void _listen();
+    void _onNewConnection();
+
+private:
+    QByteArray _readingsLine();
+
+    std::vector<std::string> _sensorNames;
+    int _interval;
+    SimulatedLatency _latency;
+    std::mt19937 _random;
+
+    QTcpServer* _server;
+    quint16 _port;
+    QThread _thread;
+};
+
+#endif // FAKETHERMORASPSERVER_H
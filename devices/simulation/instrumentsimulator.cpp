@@ -0,0 +1,225 @@
+#include "instrumentsimulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+const double LOAD_RESISTANCE = 100; // Ohm, connected to the low voltage outputs
+const double SENSOR_RESISTANCE = 1e8; // Ohm, seen by the Keithley
+const double ROOM_TEMPERATURE = 20; // °C
+const double BATH_TIME_CONSTANT = 60; // s until the bath got 63 % closer to its target
+
+namespace {
+
+// Split e.g. "V1 5.0" into "V1" and "5.0"
+void splitCommand(const std::string& command, std::string& header, std::string& argument) {
+    size_t space = command.find(' ');
+    header = command.substr(0, space);
+    argument = (space == std::string::npos) ? "" : command.substr(space + 1);
+    // A leading colon only resets the SCPI command tree
+    if (not header.empty() and header[0] == ':')
+        header.erase(0, 1);
+}
+
+std::string format(const char* format, double value) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), format, value);
+    return buf;
+}
+
+}
+
+SimulatedLatency::SimulatedLatency(int latency, int jitter)
+    : _random(std::random_device()())
+{
+    _latency = latency;
+    _jitter = jitter;
+}
+
+int SimulatedLatency::next() {
+    if (_jitter <= 0)
+        return std::max(_latency, 0);
+    std::uniform_int_distribution<int> distribution(_latency - _jitter, _latency + _jitter);
+    return std::max(distribution(_random), 0);
+}
+
+TTiSimulator::TTiSimulator() {
+    for (int i = 0; i < 2; ++i) {
+        _volt[i] = 0;
+        _curr[i] = 0;
+        _power[i] = false;
+    }
+}
+
+std::string TTiSimulator::respond(const std::string& command) {
+    std::string header, argument;
+    splitCommand(command, header, argument);
+
+    if (header == "*IDN?")
+        return "THURLBY THANDAR,PL303QMD-P,0,3.02-4.06";
+    if (header == "OPALL") {
+        _power[0] = _power[1] = (argument == "1");
+        return "";
+    }
+
+    // All other commands refer to output 1 or 2, e.g. V1, I2?, OP1
+    size_t digit = header.find_first_of("12");
+    if (digit == std::string::npos)
+        return "";
+    int i = header[digit] - '1';
+    std::string name = header.substr(0, digit);
+    bool isQuery = header.back() == '?';
+
+    double currApp = _power[i] ? std::min(_volt[i] / LOAD_RESISTANCE, _curr[i]) : 0;
+    if (name == "V" and isQuery)
+        return header.substr(0, digit + 1) + format(" %.3f", _power[i] ? _volt[i] : 0);
+    if (name == "I" and isQuery)
+        return header.substr(0, digit + 1) + format(" %.4f", currApp);
+    if (name == "OP" and isQuery)
+        return _power[i] ? "1" : "0";
+    if (name == "V")
+        _volt[i] = std::atof(argument.c_str());
+    else if (name == "I")
+        _curr[i] = std::atof(argument.c_str());
+    else if (name == "OP")
+        _power[i] = (argument == "1");
+    return "";
+}
+
+KepcoSimulator::KepcoSimulator() {
+    _volt = 0;
+    _curr = 0;
+    _power = false;
+}
+
+std::string KepcoSimulator::respond(const std::string& command) {
+    std::string header, argument;
+    splitCommand(command, header, argument);
+
+    if (header == "*IDN?")
+        return "KEPCO,KLP 36-60,E1234,1.0";
+    if (header == "OUTP?")
+        return _power ? "1" : "0";
+    if (header == "MEAS:VOLT?")
+        return format("%.4f", _power ? _volt : 0);
+    if (header == "MEAS:CURR?")
+        return format("%.4f", _power ? std::min(_volt / LOAD_RESISTANCE, _curr) : 0);
+    if (header == "VOLT")
+        _volt = std::atof(argument.c_str());
+    else if (header == "CURR")
+        _curr = std::atof(argument.c_str());
+    else if (header == "OUTP")
+        _power = (argument == "ON");
+    return "";
+}
+
+KeithleySimulator::KeithleySimulator() {
+    _volt = 0;
+    _compliance = 0;
+    _power = false;
+}
+
+std::string KeithleySimulator::respond(const std::string& command) {
+    std::string header, argument;
+    splitCommand(command, header, argument);
+
+    if (header == "*IDN?")
+        return "KEITHLEY INSTRUMENTS INC.,MODEL 2410,1234567,C34 Sep 21 2016 15:30:00/A02  /U/M";
+    if (header == "OUTPUT1:STATE?")
+        return _power ? "1" : "0";
+    if (header == "READ?") {
+        // Voltage, current, resistance, timestamp and status
+        double curr = _volt / SENSOR_RESISTANCE;
+        if (std::abs(curr) > _compliance)
+            curr = std::copysign(_compliance, curr);
+        return format("%+.6E", _volt) + format(",%+.6E", curr) + ",+9.910000E+37,+1.234567E+03,+3.940000E+04";
+    }
+    if (header == "*RST") {
+        _volt = 0;
+        _power = false;
+    } else if (header == "OUTPUT1:STATE")
+        _power = (argument == "ON");
+    else if (header == "SOUR:VOLT:LEV")
+        _volt = std::atof(argument.c_str());
+    else if (header == "SENS:CURR:PROT")
+        _compliance = std::atof(argument.c_str());
+    return "";
+}
+
+ChillerSimulator::ChillerSimulator() {
+    _workingTemperature = ROOM_TEMPERATURE;
+    _circulatorOn = false;
+    _temperature = ROOM_TEMPERATURE;
+    _clock.start();
+}
+
+double ChillerSimulator::_bathTemperature() {
+    double target = _circulatorOn ? _workingTemperature : ROOM_TEMPERATURE;
+    double elapsed = _clock.restart() / 1000.;
+    _temperature += (target - _temperature) * (1 - std::exp(-elapsed / BATH_TIME_CONSTANT));
+    return _temperature;
+}
+
+JulaboSimulator::JulaboSimulator() {
+    _parameters["in_sp_00"] = format("%.2f", _workingTemperature);
+    _parameters["in_sp_07"] = "1";
+    _parameters["in_mode_05"] = "0";
+    _parameters["in_par_06"] = "0.1";
+    _parameters["in_par_07"] = "3";
+    _parameters["in_par_08"] = "0";
+}
+
+std::string JulaboSimulator::respond(const std::string& command) {
+    std::string header, argument;
+    splitCommand(command, header, argument);
+
+    if (header == "version")
+        return "JULABO TOPTECH-SERIES MC-2 VERSION 4.0";
+    if (header == "status")
+        return _circulatorOn ? "03 REMOTE START" : "02 REMOTE STOP";
+    if (header == "in_pv_00" or header == "in_pv_03")
+        return format("%.2f", _bathTemperature());
+    if (header == "in_pv_01")
+        return _circulatorOn ? "10" : "0";
+
+    if (header.compare(0, 4, "out_") == 0) {
+        // Bring the bath up to date before its target changes
+        _bathTemperature();
+        std::string parameter = "in_" + header.substr(4);
+        _parameters[parameter] = argument;
+        if (parameter == "in_sp_00")
+            _workingTemperature = std::atof(argument.c_str());
+        else if (parameter == "in_mode_05")
+            _circulatorOn = std::atoi(argument.c_str()) != 0;
+        return "";
+    }
+    if (_parameters.count(header) > 0)
+        return _parameters.at(header);
+    return "";
+}
+
+std::string HuberSimulator::respond(const std::string& command) {
+    std::string header, argument;
+    splitCommand(command, header, argument);
+
+    // Values are integers with sign and five digits, temperatures in 0.01 °C
+    char buf[32];
+    if (header == "SP@") {
+        _bathTemperature();
+        _workingTemperature = std::atoi(argument.c_str()) / 100.;
+    } else if (header == "CA@") {
+        _bathTemperature();
+        _circulatorOn = std::atoi(argument.c_str()) != 0;
+    }
+
+    if (header == "TI?")
+        snprintf(buf, sizeof(buf), "TI %+06d", static_cast<int>(std::lround(_bathTemperature() * 100)));
+    else if (header == "SP?" or header == "SP@")
+        snprintf(buf, sizeof(buf), "SP %+06d", static_cast<int>(std::lround(_workingTemperature * 100)));
+    else if (header == "CA?" or header == "CA@")
+        snprintf(buf, sizeof(buf), "CA %+06d", _circulatorOn ? 1 : 0);
+    else
+        return "";
+    return buf;
+}
@@ -0,0 +1,129 @@
+#ifndef INSTRUMENTSIMULATOR_H
+#define INSTRUMENTSIMULATOR_H
+
+#include <QElapsedTimer>
+
+#include <map>
+#include <random>
+#include <string>
+
+/**
+ * Answers the commands of a device driver like the real device would.
+ * Used by MockCommunicator and FakeSerialDevice so that the program can
+ * be run without any hardware. Not thread-safe.
+ */
+class InstrumentSimulator {
+public:
+    virtual ~InstrumentSimulator() {}
+
+    /**
+     * Handle one command as sent by the driver
+     * @param command The command without suffix
+     * @return The answer without terminator. Empty if the device
+     * doesn't answer to the command
+     */
+    virtual std::string respond(const std::string& command) = 0;
+};
+
+/**
+ * Time a simulated device takes for an answer. Uniformly distributed
+ * within jitter ms around latency ms. Not thread-safe.
+ */
+class SimulatedLatency {
+public:
+    SimulatedLatency(int latency = 0, int jitter = 0);
+
+    /**
+     * @return The next latency in ms, never negative
+     */
+    int next();
+
+private:
+    int _latency;
+    int _jitter;
+    std::mt19937 _random;
+};
+
+/**
+ * TTi PL303QMD-P with two outputs
+ */
+class TTiSimulator : public InstrumentSimulator {
+public:
+    TTiSimulator();
+    std::string respond(const std::string& command) override;
+
+private:
+    double _volt[2];
+    double _curr[2];
+    bool _power[2];
+};
+
+/**
+ * Kepco KLP 36-60
+ */
+class KepcoSimulator : public InstrumentSimulator {
+public:
+    KepcoSimulator();
+    std::string respond(const std::string& command) override;
+
+private:
+    double _volt;
+    double _curr;
+    bool _power;
+};
+
+/**
+ * Keithley 2410 measuring the leakage current of a sensor
+ */
+class KeithleySimulator : public InstrumentSimulator {
+public:
+    KeithleySimulator();
+    std::string respond(const std::string& command) override;
+
+private:
+    double _volt;
+    double _compliance; // A
+    bool _power;
+};
+
+/**
+ * Base for chillers. The bath approaches the working temperature while
+ * the circulator is on and the room temperature otherwise.
+ */
+class ChillerSimulator : public InstrumentSimulator {
+public:
+    ChillerSimulator();
+
+protected:
+    double _bathTemperature();
+
+    double _workingTemperature;
+    bool _circulatorOn;
+
+private:
+    double _temperature;
+    QElapsedTimer _clock;
+};
+
+/**
+ * Julabo FP50 chiller. Settings written with out_* commands are read
+ * back with the corresponding in_* commands.
+ */
+class JulaboSimulator : public ChillerSimulator {
+public:
+    JulaboSimulator();
+    std::string respond(const std::string& command) override;
+
+private:
+    std::map<std::string, std::string> _parameters;
+};
+
+/**
+ * Huber Petite Fleur chiller
+ */
+class HuberSimulator : public ChillerSimulator {
+public:
+    std::string respond(const std::string& command) override;
+};
+
+#endif // INSTRUMENTSIMULATOR_H
@@ -2,6 +2,9 @@
 
 #include <QFileInfo> 
 
+#include <cmath>
+#include <limits>
+
 BurnInCommand::BurnInCommand(BurnInCommandType type) {
     _type = type;
 }
@@ -10,10 +13,11 @@ BurnInCommandType BurnInCommand::getType() const {
     return _type;
 }
 
-BurnInWaitCommand::BurnInWaitCommand(unsigned int wait_):
+BurnInWaitCommand::BurnInWaitCommand(unsigned int wait_, QString variable_):
     BurnInCommand(COMMAND_WAIT) {
     
     wait = wait_;
+    variable = variable_;
 }
 
 BurnInVoltageSourceOutputCommand::BurnInVoltageSourceOutputCommand(PowerControlClass* source_, QString sourceName_, int output_, bool on_):
@@ -25,13 +29,14 @@ BurnInVoltageSourceOutputCommand::BurnInVoltageSourceOutputCommand(PowerControlC
     on = on_;
 }
 
-BurnInVoltageSourceSetCommand::BurnInVoltageSourceSetCommand(PowerControlClass* source_, QString sourceName_, int output_, double value_):
+BurnInVoltageSourceSetCommand::BurnInVoltageSourceSetCommand(PowerControlClass* source_, QString sourceName_, int output_, double value_, QString variable_):
     BurnInCommand(COMMAND_VOLTAGESOURCESET) {
     
     source = source_;
     sourceName = sourceName_;
     output = output_;
     value = value_;
+    variable = variable_;
 }
 
 BurnInChillerOutputCommand::BurnInChillerOutputCommand(Chiller* chiller_, QString chillerName_, bool on_):
@@ -42,12 +47,13 @@ BurnInChillerOutputCommand::BurnInChillerOutputCommand(Chiller* chiller_, QStrin
     on = on_;
 }
 
-BurnInChillerSetCommand::BurnInChillerSetCommand(Chiller* chiller_, QString chillerName_, double value_):
+BurnInChillerSetCommand::BurnInChillerSetCommand(Chiller* chiller_, QString chillerName_, double value_, QString variable_):
     BurnInCommand(COMMAND_CHILLERSET) {
         
     chiller = chiller_;
     chillerName = chillerName_;
     value = value_;
+    variable = variable_;
 }
 
 BurnInDAQCommand::BurnInDAQCommand(QString execName_, QString opts_):
@@ -56,3 +62,50 @@ BurnInDAQCommand::BurnInDAQCommand(QString execName_, QString opts_):
     execName = execName_;
     opts = opts_;
 }
+
+BurnInParallelCommand::BurnInParallelCommand():
+    BurnInCommand(COMMAND_PARALLEL) {
+    
+}
+
+BurnInParallelCommand::~BurnInParallelCommand() {
+    qDeleteAll(commands);
+}
+
+BurnInRepeatCommand::BurnInRepeatCommand(unsigned int count_):
+    BurnInCommand(COMMAND_REPEAT) {
+    
+    count = count_;
+}
+
+BurnInRepeatCommand::~BurnInRepeatCommand() {
+    qDeleteAll(commands);
+}
+
+BurnInForCommand::BurnInForCommand(QString variable_, double start_, double stop_, double step_):
+    BurnInCommand(COMMAND_FOR) {
+    
+    variable = variable_;
+    start = start_;
+    stop = stop_;
+    step = step_;
+}
+
+BurnInForCommand::~BurnInForCommand() {
+    qDeleteAll(commands);
+}
+
+unsigned int BurnInForCommand::getCount() const {
+    if (step == 0 or (stop - start) / step < 0)
+        return 0;
+    // Tolerate rounding errors, e.g. for 0:1:0.1
+    double steps = std::floor((stop - start) / step + 1e-9);
+    // Converting a value out of range would be undefined
+    if (steps >= std::numeric_limits<unsigned int>::max())
+        return std::numeric_limits<unsigned int>::max();
+    return static_cast<unsigned int>(steps) + 1;
+}
+
+double BurnInForCommand::getValue(unsigned int i) const {
+    return start + i * step;
+}
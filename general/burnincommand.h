@@ -2,6 +2,7 @@
 #define BURNINCOMMAND_H
 
 #include <QString>
+#include <QVector>
 
 #include "general/systemcontrollerclass.h"
 #include "devices/power/powercontrolclass.h"
@@ -22,12 +23,16 @@ enum BurnInCommandType {
     COMMAND_CHILLEROUTPUT,
     COMMAND_CHILLERSET,
     COMMAND_DAQCMD,
+    COMMAND_PARALLEL,
+    COMMAND_REPEAT,
+    COMMAND_FOR,
 };
 
 class AbstractCommandHandler;
 
 class BurnInCommand {
 public:
+    virtual ~BurnInCommand() {}
     BurnInCommandType getType() const;
     virtual void accept(AbstractCommandHandler& handler) = 0;
     
@@ -44,6 +49,9 @@ class BurnInVoltageSourceSetCommand;
 class BurnInChillerOutputCommand;
 class BurnInChillerSetCommand;
 class BurnInDAQCommand;
+class BurnInParallelCommand;
+class BurnInRepeatCommand;
+class BurnInForCommand;
 
 class AbstractCommandHandler {
 public:
@@ -53,16 +61,20 @@ public:
     virtual void handleCommand(BurnInChillerOutputCommand& command) = 0;
     virtual void handleCommand(BurnInChillerSetCommand& command) = 0;
     virtual void handleCommand(BurnInDAQCommand& command) = 0;
+    virtual void handleCommand(BurnInParallelCommand& command) = 0;
+    virtual void handleCommand(BurnInRepeatCommand& command) = 0;
+    virtual void handleCommand(BurnInForCommand& command) = 0;
 };
 
 class BurnInWaitCommand : public BurnInCommand {
 public:
-    BurnInWaitCommand(unsigned int wait_);
+    BurnInWaitCommand(unsigned int wait_, QString variable_ = "");
     void accept(AbstractCommandHandler& handler) override {
         handler.handleCommand(*this);
     }
 
     unsigned int wait;
+    QString variable; // Loop variable giving the time instead of wait, empty if none
 };
 
 class BurnInVoltageSourceOutputCommand: public BurnInCommand {
@@ -80,7 +92,7 @@ public:
 
 class BurnInVoltageSourceSetCommand: public BurnInCommand {
 public:
-    BurnInVoltageSourceSetCommand(PowerControlClass* source_, QString sourceName_, int output_, double value_);
+    BurnInVoltageSourceSetCommand(PowerControlClass* source_, QString sourceName_, int output_, double value_, QString variable_ = "");
     void accept(AbstractCommandHandler& handler) override {
         handler.handleCommand(*this);
     }
@@ -89,6 +101,7 @@ public:
     QString sourceName;
     int output;
     double value;
+    QString variable; // Loop variable giving the value instead, empty if none
 };
 
 class BurnInChillerOutputCommand : public BurnInCommand {
@@ -105,7 +118,7 @@ public:
 
 class BurnInChillerSetCommand : public BurnInCommand {
 public:
-    BurnInChillerSetCommand(Chiller* chiller_, QString chillerName_, double value_);
+    BurnInChillerSetCommand(Chiller* chiller_, QString chillerName_, double value_, QString variable_ = "");
     void accept(AbstractCommandHandler& handler) override {
         handler.handleCommand(*this);
     }
@@ -113,6 +126,7 @@ public:
     Chiller* chiller;
     QString chillerName;
     double value;
+    QString variable; // Loop variable giving the value instead, empty if none
 };
 
 // Potentially dangerous: Itended to run DAQ commands but allows
@@ -128,4 +142,72 @@ public:
     QString opts;
 };
 
+// Runs its commands at the same time and finishes when all of them
+// finished. The commands must use different devices.
+class BurnInParallelCommand : public BurnInCommand {
+public:
+    BurnInParallelCommand();
+    virtual ~BurnInParallelCommand();
+    
+    BurnInParallelCommand(const BurnInParallelCommand& other) = delete;
+    BurnInParallelCommand& operator=(const BurnInParallelCommand& other) = delete;
+    
+    void accept(AbstractCommandHandler& handler) override {
+        handler.handleCommand(*this);
+    }
+    
+    QVector<BurnInCommand*> commands; // Owned by this command
+};
+
+// Runs its commands count times. The commands are kept only once, no
+// matter how often they are run.
+class BurnInRepeatCommand : public BurnInCommand {
+public:
+    BurnInRepeatCommand(unsigned int count_);
+    virtual ~BurnInRepeatCommand();
+    
+    BurnInRepeatCommand(const BurnInRepeatCommand& other) = delete;
+    BurnInRepeatCommand& operator=(const BurnInRepeatCommand& other) = delete;
+    
+    void accept(AbstractCommandHandler& handler) override {
+        handler.handleCommand(*this);
+    }
+    
+    unsigned int count;
+    QVector<BurnInCommand*> commands; // Owned by this command
+};
+
+// Runs its commands once for every value of a variable from start to
+// stop (inclusive) in steps of step. Commands refer to the value with
+// $variable.
+class BurnInForCommand : public BurnInCommand {
+public:
+    BurnInForCommand(QString variable_, double start_, double stop_, double step_);
+    virtual ~BurnInForCommand();
+    
+    BurnInForCommand(const BurnInForCommand& other) = delete;
+    BurnInForCommand& operator=(const BurnInForCommand& other) = delete;
+    
+    void accept(AbstractCommandHandler& handler) override {
+        handler.handleCommand(*this);
+    }
+    
+    /**
+     * @return Number of values the variable takes. 0 if step leads away
+     * from stop
+     */
+    unsigned int getCount() const;
+    
+    /**
+     * @return Value of the variable in iteration i, starting at 0
+     */
+    double getValue(unsigned int i) const;
+    
+    QString variable;
+    double start;
+    double stop;
+    double step;
+    QVector<BurnInCommand*> commands; // Owned by this command
+};
+
 #endif // BURNINCOMMAND_H
@@ -0,0 +1,447 @@
+#include "commandexecuter.h"
+#include "general/BurnInException.h"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+CommandExecuter::CommandExecuter(const CommandProgram& program, const SystemControllerClass* controller, QObject *parent) :
+    QObject(parent)
+{
+    _program = program;
+    _controller = controller;
+    _shouldAbort = false;
+    _shouldPause = false;
+    _isRunning = false;
+    _hadError = false;
+}
+
+void CommandExecuter::start() {
+    _shouldAbort = false;
+    _hadError = false;
+    _isRunning = true;
+    
+    const QVector<Instruction>& instructions = _program.getInstructions();
+    std::vector<double> variables(_program.getVariableCount(), 0);
+    std::vector<LoopState> loops;
+    QString prefix;
+    int n = -1;
+    int pc = 0;
+    while (pc < instructions.size()) {
+        const Instruction& instruction = instructions[pc];
+        if (instruction.command != n) {
+            if (n >= 0)
+                emit commandFinished(n, QDateTime::currentDateTime());
+            n = instruction.command;
+            emit commandStarted(n, QDateTime::currentDateTime());
+        }
+        
+        bool error = false;
+        switch (instruction.op) {
+        case OP_LOOP:
+            if (instruction.count == 0) {
+                pc = instruction.jump;
+                continue;
+            }
+            loops.push_back({pc, 0});
+            if (instruction.variable >= 0)
+                variables[instruction.variable] = instruction.value;
+            prefix = _getLoopPrefix(loops, variables);
+            ++pc;
+            continue;
+        case OP_NEXT: {
+            LoopState& loop = loops.back();
+            const Instruction& begin = instructions[loop.begin];
+            if (++loop.iteration < begin.count) {
+                if (begin.variable >= 0)
+                    variables[begin.variable] = begin.value + loop.iteration * begin.step;
+                pc = loop.begin + 1;
+            } else {
+                loops.pop_back();
+                ++pc;
+            }
+            prefix = _getLoopPrefix(loops, variables);
+            continue;
+        }
+        case OP_PARALLEL:
+            error = not _runParallel(pc, prefix, variables);
+            pc += instruction.count + 1;
+            break;
+        case OP_WAIT:
+        case OP_VOLTAGESOURCEOUTPUT:
+        case OP_VOLTAGESOURCESET:
+        case OP_CHILLEROUTPUT:
+        case OP_CHILLERSET:
+        case OP_DAQCMD: {
+            InstructionHandler handler(this, instruction, prefix);
+            handler.run(instruction.variable >= 0 ? variables[instruction.variable] : instruction.value);
+            error = handler.error;
+            ++pc;
+            break;
+        }
+        }
+        
+        if (error) {
+            _hadError = true;
+            break; // Halt on errors
+        }
+        
+        if (_shouldAbort)
+            break;
+        if (_shouldPause) {
+            emit commandStatusUpdate(n, prefix + "Paused");
+            _waitWhilePaused();
+            emit commandStatusUpdate(n, prefix + "Unpaused");
+        }
+    }
+    if (n >= 0)
+        emit commandFinished(n, QDateTime::currentDateTime());
+    
+    _isRunning = false;
+    emit allFinished();
+}
+
+QString CommandExecuter::_getLoopPrefix(const std::vector<LoopState>& loops, const std::vector<double>& variables) const {
+    QString prefix;
+    for (const auto& loop: loops) {
+        const Instruction& begin = _program.getInstructions()[loop.begin];
+        if (begin.variable >= 0)
+            prefix += _program.getVariableName(begin.variable) + " = " + QString::number(variables[begin.variable]) + ": ";
+        else
+            prefix += "Iteration " + QString::number(loop.iteration + 1) + "/" + QString::number(begin.count) + ": ";
+    }
+    return prefix;
+}
+
+bool CommandExecuter::_runParallel(int pc, const QString& prefix, const std::vector<double>& variables) {
+    const QVector<Instruction>& instructions = _program.getInstructions();
+    const Instruction& parallel = instructions[pc];
+    emit commandStatusUpdate(parallel.command, prefix + "Running " + QString::number(parallel.count) + " commands in parallel");
+    
+    // Every instruction runs on a thread of its own and waits for its
+    // device independently of the others
+    std::vector<std::unique_ptr<InstructionHandler>> handlers;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < parallel.count; ++i) {
+        const Instruction& instruction = instructions[pc + 1 + i];
+        double value = instruction.variable >= 0 ? variables[instruction.variable] : instruction.value;
+        handlers.emplace_back(new InstructionHandler(this, instruction, prefix + "[" + QString::number(i + 1) + "] "));
+        InstructionHandler* handler = handlers.back().get();
+        threads.emplace_back([handler, value]() {
+            handler->run(value);
+        });
+    }
+    for (auto& thread: threads)
+        thread.join();
+    
+    bool error = false;
+    for (const auto& handler: handlers) {
+        if (handler->error)
+            error = true;
+    }
+    if (error)
+        emit commandStatusUpdate(parallel.command, prefix + "Error in a parallel command");
+    else
+        emit commandStatusUpdate(parallel.command, prefix + "All parallel commands finished");
+    return not error;
+}
+
+bool CommandExecuter::isPaused() const {
+    return _shouldPause;
+}
+
+bool CommandExecuter::isRunning() const {
+    return _isRunning;
+}
+
+bool CommandExecuter::hadError() const {
+    return _hadError;
+}
+
+void CommandExecuter::togglePause() {
+    _shouldPause = not _shouldPause;
+    _wakeUpWaiting();
+}
+
+void CommandExecuter::abort() {
+    _shouldAbort = true;
+    _isRunning = false;
+    _wakeUpWaiting();
+}
+
+void CommandExecuter::_wakeUpWaiting() {
+    QMutexLocker locker(&_waitMutex);
+    _wakeUp.wakeAll();
+}
+
+void CommandExecuter::_waitUntil(std::function<bool()> reached) {
+    QMutexLocker locker(&_waitMutex);
+    while (not _shouldAbort and not reached())
+        _wakeUp.wait(&_waitMutex, WAIT_INTERVAL);
+}
+
+void CommandExecuter::_waitWhilePaused() {
+    _waitUntil([this]() {
+        return not _shouldPause;
+    });
+}
+
+CommandExecuter::InstructionHandler::InstructionHandler(CommandExecuter* executer, const Instruction& instruction, const QString& prefix) :
+    _instruction(instruction)
+{
+    _executer = executer;
+    _prefix = prefix;
+    
+    error = false;
+}
+
+void CommandExecuter::InstructionHandler::_updateStatus(const QString& status) {
+    emit _executer->commandStatusUpdate(_instruction.command, _prefix + status);
+}
+
+void CommandExecuter::InstructionHandler::run(double value) {
+    const CommandProgram& program = _executer->_program;
+    try {
+        switch (_instruction.op) {
+        case OP_WAIT:
+            _wait(value);
+            break;
+        case OP_VOLTAGESOURCEOUTPUT:
+            _setVoltageSourceOutput(program.getSource(_instruction.device), value != 0);
+            break;
+        case OP_VOLTAGESOURCESET:
+            _setVoltage(program.getSource(_instruction.device), value);
+            break;
+        case OP_CHILLEROUTPUT:
+            _setChillerOutput(program.getChiller(_instruction.device), value != 0);
+            break;
+        case OP_CHILLERSET:
+            _setChillerTemperature(program.getChiller(_instruction.device), value);
+            break;
+        case OP_DAQCMD:
+            _runDaqCommand(program.getDaqExecName(_instruction.device), program.getDaqOpts(_instruction.device));
+            break;
+        case OP_PARALLEL:
+        case OP_LOOP:
+        case OP_NEXT:
+            // Run by the executer itself
+            break;
+        }
+    } catch (const BurnInException& e) {
+        _updateStatus("Error: " + QString(e.what()));
+        error = true;
+    }
+}
+
+void CommandExecuter::InstructionHandler::_wait(double seconds) {
+    qint64 remaining = std::llround(seconds * 1000); // ms
+    _updateStatus("Waiting");
+    
+    // The time the run is paused doesn't count
+    QElapsedTimer clock;
+    clock.start();
+    QMutexLocker locker(&_executer->_waitMutex);
+    while (not _executer->_shouldAbort and remaining > 0) {
+        if (_executer->_shouldPause) {
+            remaining -= clock.restart();
+            locker.unlock();
+            _updateStatus("Paused");
+            _executer->_waitWhilePaused();
+            _updateStatus("Waiting");
+            locker.relock();
+            clock.restart();
+            continue;
+        }
+        _executer->_wakeUp.wait(&_executer->_waitMutex, static_cast<unsigned long>(remaining));
+        remaining -= clock.restart();
+    }
+    locker.unlock();
+    _updateStatus("Wait finished");
+}
+
+void CommandExecuter::InstructionHandler::_setVoltageSourceOutput(PowerControlClass* source, bool on) {
+    int output = _instruction.output;
+    if (on) {
+        _updateStatus("Turning on output");
+        source->getContext()->call([source, output]() {
+            source->onPower(output);
+        });
+    } else {
+        _updateStatus("Turning off output");
+        source->getContext()->call([source, output]() {
+            source->offPower(output);
+        });
+    }
+    
+    if (source->getPower(output)) {
+        if (not _executer->_shouldAbort)
+            _waitForVoltage(source, output);
+        _updateStatus("Voltage source turned on. Voltage at set value.");
+    } else
+        _updateStatus("Voltage source turned off.");
+}
+
+void CommandExecuter::InstructionHandler::_setVoltage(PowerControlClass* source, double value) {
+    int output = _instruction.output;
+    _updateStatus("Setting voltage to " + QString::number(value) + " V");
+    source->getContext()->call([source, output, value]() {
+        source->setVolt(value, output);
+    });
+    
+    if (source->getPower(output)) {
+        if (not _executer->_shouldAbort)
+            _waitForVoltage(source, output);
+        _updateStatus("Voltage applied");
+    } else
+        _updateStatus("Voltage set. Voltage source output not turned on.");
+}
+
+void CommandExecuter::InstructionHandler::_waitForVoltage(PowerControlClass* source, int output) {
+    _updateStatus("Waiting for output to reach voltage");
+    
+    // Output 0 means all outputs. The targets are what was just set, the
+    // applied voltages are taken from the state table
+    const SystemControllerClass* controller = _executer->_controller;
+    std::vector<int> channels;
+    std::vector<double> targets;
+    for (int i = 1; i <= source->getNumOutputs(); ++i) {
+        if (output != 0 and i != output)
+            continue;
+        int channel = controller->getChannelId(controller->getChannelName(source, "voltage", i));
+        if (channel < 0)
+            continue;
+        channels.push_back(channel);
+        targets.push_back(source->getVolt(i));
+    }
+    
+    // Check again as soon as a device published new readings
+    CommandExecuter* executer = _executer;
+    QMetaObject::Connection connection = QObject::connect(controller,
+        &SystemControllerClass::statePublished, executer, [executer](quint64) {
+        executer->_wakeUpWaiting();
+    }, Qt::DirectConnection);
+    
+    _executer->_waitUntil([this, controller, channels, targets]() {
+        StateTable* table = controller->getStateTable();
+        for (size_t i = 0; i < channels.size(); ++i) {
+            if (std::abs(table->get(channels[i]).value - targets[i]) > VOLTAGESRC_EPSILON)
+                return false;
+        }
+        return true;
+    });
+    
+    QObject::disconnect(connection);
+}
+
+void CommandExecuter::InstructionHandler::_setChillerOutput(Chiller* chiller, bool on) {
+    bool ok;
+    bool circulatorOn;
+    if (on) {
+        _updateStatus("Turning chiller on");
+        chiller->getContext()->call([chiller, &ok, &circulatorOn]() {
+            ok = chiller->SetCirculatorOn();
+            circulatorOn = chiller->GetCirculatorStatus();
+        });
+        if (not ok) {
+            _updateStatus("Error: Could not turn on chiller");
+            error = true;
+            return;
+        }
+    } else {
+        _updateStatus("Turning chiller off");
+        chiller->getContext()->call([chiller, &ok, &circulatorOn]() {
+            ok = chiller->SetCirculatorOff();
+            circulatorOn = chiller->GetCirculatorStatus();
+        });
+        if (not ok) {
+            _updateStatus("Error: Could not turn off chiller");
+            error = true;
+            return;
+        }
+    }
+    
+    if (circulatorOn) {
+        _waitForChiller(chiller);
+        if (not _executer->_shouldAbort)
+            _updateStatus("Chiller turned on. Bath at desired temperature");
+    } else
+        _updateStatus("Chiller turned off");
+}
+
+void CommandExecuter::InstructionHandler::_setChillerTemperature(Chiller* chiller, double value) {
+    _updateStatus("Setting chiller temperature to " + QString::number(value) + " °C");
+    bool ok;
+    bool circulatorOn;
+    chiller->getContext()->call([chiller, value, &ok, &circulatorOn]() {
+        ok = chiller->SetWorkingTemperature(value);
+        circulatorOn = chiller->GetCirculatorStatus();
+    });
+    if (not ok) {
+        _updateStatus("Error: Could not set temperature");
+        error = true;
+        return;
+    }
+    
+    if (circulatorOn) {
+        _waitForChiller(chiller);
+        if (not _executer->_shouldAbort)
+            _updateStatus("Temperature set. Bath at desired temperature");
+    } else
+        _updateStatus("Temperature set. Chiller not turned on");
+    
+}
+
+void CommandExecuter::InstructionHandler::_waitForChiller(Chiller* chiller) {
+    _updateStatus("Waiting for bath to reach temperature");
+    
+    // The bath temperature is taken from the state table, which gets
+    // every reading, also those the change filter of the chiller holds
+    // back. The target is what the chiller has set now.
+    const SystemControllerClass* controller = _executer->_controller;
+    int bath = controller->getChannelId(controller->getChannelName(chiller, "bath_temperature"));
+    if (bath < 0) {
+        _updateStatus("Error: No bath temperature of the chiller");
+        error = true;
+        return;
+    }
+    float working;
+    chiller->getContext()->call([chiller, &working]() {
+        working = chiller->GetWorkingTemperature();
+    });
+    
+    // Check again as soon as a device published new readings
+    CommandExecuter* executer = _executer;
+    QMetaObject::Connection connection = QObject::connect(controller,
+        &SystemControllerClass::statePublished, executer, [executer](quint64) {
+        executer->_wakeUpWaiting();
+    }, Qt::DirectConnection);
+    
+    _executer->_waitUntil([this, controller, bath, working]() {
+        return std::abs(controller->getStateTable()->get(bath).value - working) <= CHILLER_TEMP_EPSILON;
+    });
+    
+    QObject::disconnect(connection);
+}
+
+void CommandExecuter::InstructionHandler::_runDaqCommand(const QString& execName, const QString& opts) {
+    DAQModule* module = _executer->_controller->getDaqModules()[0];
+    if (module == nullptr) {
+        _updateStatus("Error: No DAQ module connected");
+        error = true;
+        return;
+    }
+    
+    _updateStatus("Running DAQ command");
+    try {
+        module->runACFBinary(execName, opts, true);
+    } catch (const BurnInException& e) {
+        _updateStatus("Error: " + QString(e.what()));
+        error = true;
+        return;
+    }
+    _updateStatus("DAQ command executed");
+}
@@ -0,0 +1,129 @@
+#ifndef COMMANDEXECUTER_H
+#define COMMANDEXECUTER_H
+
+#include <QObject>
+#include <QThread>
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "general/commandprogram.h"
+#include "general/systemcontrollerclass.h"
+
+class CommandExecuter : public QObject {
+    Q_OBJECT
+
+public:
+    CommandExecuter(const CommandProgram& program, const SystemControllerClass* controller, QObject *parent = nullptr);
+    bool isPaused() const;
+    bool isRunning() const;
+    
+    /**
+     * @return Whether the last run stopped because a command failed
+     */
+    bool hadError() const;
+    
+public slots:
+    void start();
+    void togglePause();
+    void abort();
+    
+signals:
+    void commandStarted(int n, QDateTime dt);
+    void commandFinished(int n, QDateTime dt);
+    void commandStatusUpdate(int n, QString status);
+    void allFinished();
+
+private:
+    CommandProgram _program;
+    const SystemControllerClass* _controller;
+    
+    std::atomic<bool> _shouldAbort;
+    std::atomic<bool> _shouldPause;
+    std::atomic<bool> _isRunning;
+    std::atomic<bool> _hadError;
+    
+    // Commands waiting for a device are woken up when a reading arrived
+    // or when the run was aborted or paused
+    QMutex _waitMutex;
+    QWaitCondition _wakeUp;
+    
+    void _wakeUpWaiting();
+    
+    /**
+     * Wait until a condition is met or the run is aborted. The condition
+     * is checked whenever _wakeUp is signaled and at least every
+     * WAIT_INTERVAL.
+     * @param reached The condition. Called with _waitMutex locked
+     */
+    void _waitUntil(std::function<bool()> reached);
+    
+    /**
+     * Wait until the run is unpaused or aborted
+     */
+    void _waitWhilePaused();
+    
+    const unsigned long WAIT_INTERVAL = 1000; // ms
+    
+    // Iteration of a loop being run
+    struct LoopState {
+        int begin; // Index of the LOOP instruction
+        qint32 iteration;
+    };
+    
+    /**
+     * @return Put in front of status updates, tells which iteration of
+     *     the loops is running
+     */
+    QString _getLoopPrefix(const std::vector<LoopState>& loops, const std::vector<double>& variables) const;
+    
+    /**
+     * Run the instructions following a PARALLEL instruction, every one
+     * on a thread of its own
+     * @return false if one of them failed
+     */
+    bool _runParallel(int pc, const QString& prefix, const std::vector<double>& variables);
+    
+    // Runs an instruction that controls a device or waits
+    class InstructionHandler {
+    public:
+        /**
+         * @param prefix Put in front of status updates, e.g. to tell
+         *     apart the commands of a parallel block
+         */
+        InstructionHandler(CommandExecuter* executer, const Instruction& instruction, const QString& prefix = "");
+        
+        /**
+         * @param value Value of the instruction with the loop variable
+         *     already filled in
+         */
+        void run(double value);
+        
+        bool error;
+        
+        const double VOLTAGESRC_EPSILON = 0.1; // V, for comparing two voltage values
+        const double CHILLER_TEMP_EPSILON = 0.1; // °C, for comparing two temperature values
+        
+    private:
+        CommandExecuter* _executer;
+        const Instruction& _instruction;
+        QString _prefix;
+        
+        void _updateStatus(const QString& status);
+        void _wait(double seconds);
+        void _setVoltageSourceOutput(PowerControlClass* source, bool on);
+        void _setVoltage(PowerControlClass* source, double value);
+        void _setChillerOutput(Chiller* chiller, bool on);
+        void _setChillerTemperature(Chiller* chiller, double value);
+        void _runDaqCommand(const QString& execName, const QString& opts);
+        void _waitForVoltage(PowerControlClass* source, int output);
+        void _waitForChiller(Chiller* chiller);
+    };
+    
+};
+
+#endif // COMMANDEXECUTER_H
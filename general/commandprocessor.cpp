@@ -5,7 +5,22 @@
 
 #include <QFile>
 #include <QChar>
+#include <QRegularExpression>
 #include <cmath>
+#include <limits>
+#include <set>
+#include <utility>
+
+namespace {
+
+QString removeLeadingSpace(const QString& line) {
+    int i = 0;
+    while (i < line.length() and line[i].isSpace())
+        ++i;
+    return line.mid(i);
+}
+
+}
 
 CommandProcessor::CommandProcessor(const SystemControllerClass* controller, QObject *parent) : QObject(parent) {
     _controller = controller;
@@ -52,6 +67,15 @@ QString CommandProcessor::getStringForType(BurnInCommandType type) {
     case COMMAND_DAQCMD:
         return "daqcmd";
         break;
+    case COMMAND_PARALLEL:
+        return "parallel";
+        break;
+    case COMMAND_REPEAT:
+        return "repeat";
+        break;
+    case COMMAND_FOR:
+        return "for";
+        break;
     }
     
     Q_ASSERT(false); // Should not reach.
@@ -88,7 +112,12 @@ CommandProcessor::CommandSaver::CommandSaver(QTextStream* out_) {
 }
 
 void CommandProcessor::CommandSaver::handleCommand(BurnInWaitCommand& command) {
-    *out << getStringForType(COMMAND_WAIT) << " " << command.wait << "\n";
+    *out << getStringForType(COMMAND_WAIT) << " ";
+    if (command.variable.isEmpty())
+        *out << command.wait;
+    else
+        *out << "$" << command.variable;
+    *out << "\n";
 }
 
 void CommandProcessor::CommandSaver::handleCommand(BurnInVoltageSourceOutputCommand& command) {
@@ -103,8 +132,12 @@ void CommandProcessor::CommandSaver::handleCommand(BurnInVoltageSourceSetCommand
     *out << getStringForType(COMMAND_VOLTAGESOURCESET)
          << " \"" << CommandProcessor::_escapeName(command.sourceName) << "\""
          << " " << command.output
-         << " " << command.value
-         << "\n";
+         << " ";
+    if (command.variable.isEmpty())
+        *out << command.value;
+    else
+        *out << "$" << command.variable;
+    *out << "\n";
 }
 
 void CommandProcessor::CommandSaver::handleCommand(BurnInChillerOutputCommand& command) {
@@ -117,8 +150,12 @@ void CommandProcessor::CommandSaver::handleCommand(BurnInChillerOutputCommand& c
 void CommandProcessor::CommandSaver::handleCommand(BurnInChillerSetCommand& command) {
     *out << getStringForType(COMMAND_CHILLERSET)
          << " \"" << CommandProcessor::_escapeName(command.chillerName) << "\""
-         << " " << command.value
-         << "\n";
+         << " ";
+    if (command.variable.isEmpty())
+        *out << command.value;
+    else
+        *out << "$" << command.variable;
+    *out << "\n";
 }
 
 void CommandProcessor::CommandSaver::handleCommand(BurnInDAQCommand& command) {
@@ -128,6 +165,33 @@ void CommandProcessor::CommandSaver::handleCommand(BurnInDAQCommand& command) {
          << "\n";
 }
 
+void CommandProcessor::CommandSaver::handleCommand(BurnInParallelCommand& command) {
+    *out << getStringForType(COMMAND_PARALLEL) << " {\n";
+    _saveBlock(command.commands);
+}
+
+void CommandProcessor::CommandSaver::handleCommand(BurnInRepeatCommand& command) {
+    *out << getStringForType(COMMAND_REPEAT) << " " << command.count << " {\n";
+    _saveBlock(command.commands);
+}
+
+void CommandProcessor::CommandSaver::handleCommand(BurnInForCommand& command) {
+    *out << getStringForType(COMMAND_FOR) << " " << command.variable << " in "
+         << command.start << ":" << command.stop << ":" << command.step << " {\n";
+    _saveBlock(command.commands);
+}
+
+void CommandProcessor::CommandSaver::_saveBlock(const QVector<BurnInCommand*>& commands) {
+    QString outer = indent;
+    indent += "    ";
+    for (const auto& command: commands) {
+        *out << indent;
+        command->accept(*this);
+    }
+    indent = outer;
+    *out << indent << "}\n";
+}
+
 QString CommandProcessor::_escapeName(const QString& name) {
     QString ret = name;
     
@@ -159,54 +223,250 @@ QVector<BurnInCommand*> CommandProcessor::getCommandListFromString(const QString
 }
 
 QVector<BurnInCommand*> CommandProcessor::_parseCommands(QTextStream& in) const {
+    int line_count = 0;
+    return _parseBlock(in, line_count, VariableRanges(), 0);
+}
+
+QVector<BurnInCommand*> CommandProcessor::_parseBlock(QTextStream& in, int& line_count, const VariableRanges& variables, int start_line) const {
     QVector<BurnInCommand*> list;
     
-    int line_count = 0;
-    while (not in.atEnd()) {
-        ++line_count;
-        QString line = in.readLine();
-        
-        if (line.startsWith("#") or line.isEmpty())
-            continue; // Comments and empty lines allowed
-        else if (line.startsWith(getStringForType(COMMAND_WAIT) + " ")) {
-            list.push_back(_parseWaitCommand(line, line_count));
-            
-        } else if (line.startsWith(getStringForType(COMMAND_VOLTAGESOURCEOUTPUT) + " ")) {
-            list.push_back(_parseVoltageSourceOutputCommand(line, line_count));
+    try {
+        while (not in.atEnd()) {
+            ++line_count;
+            QString line = removeLeadingSpace(in.readLine());
             
-        } else if (line.startsWith(getStringForType(COMMAND_VOLTAGESOURCESET) + " ")) {
-            list.push_back(_parseVoltageSourceSetCommand(line, line_count));
+            if (line.startsWith("#") or line.isEmpty())
+                continue; // Comments and empty lines allowed
+            else if (line.trimmed() == "}") {
+                if (start_line == 0)
+                    throw BurnInException("Line " + std::to_string(line_count) + ": } without a block");
+                return list;
+            } else if (line.trimmed() == getStringForType(COMMAND_PARALLEL) + " {")
+                list.push_back(_parseParallelBlock(in, line_count, variables));
+            else if (line.startsWith(getStringForType(COMMAND_REPEAT) + " "))
+                list.push_back(_parseRepeatBlock(line, in, line_count, variables));
+            else if (line.startsWith(getStringForType(COMMAND_FOR) + " "))
+                list.push_back(_parseForBlock(line, in, line_count, variables));
+            else
+                list.push_back(_parseCommand(line, line_count, variables));
+        }
+        
+        if (start_line != 0)
+            throw BurnInException("Line " + std::to_string(start_line) + ": Block is missing its closing }");
+    } catch (const BurnInException&) {
+        qDeleteAll(list);
+        throw;
+    }
+    
+    return list;
+}
+
+BurnInCommand* CommandProcessor::_parseCommand(const QString& line, int line_count, const VariableRanges& variables) const {
+    if (line.startsWith(getStringForType(COMMAND_WAIT) + " ")) {
+        return _parseWaitCommand(line, line_count, variables);
+        
+    } else if (line.startsWith(getStringForType(COMMAND_VOLTAGESOURCEOUTPUT) + " ")) {
+        return _parseVoltageSourceOutputCommand(line, line_count);
+        
+    } else if (line.startsWith(getStringForType(COMMAND_VOLTAGESOURCESET) + " ")) {
+        return _parseVoltageSourceSetCommand(line, line_count, variables);
+        
+    } else if (line.startsWith(getStringForType(COMMAND_CHILLEROUTPUT) + " ")) {
+        return _parseChillerOutputCommand(line, line_count);
+        
+    } else if (line.startsWith(getStringForType(COMMAND_CHILLERSET) + " ")) {
+        return _parseChillerSetCommand(line, line_count, variables);
+        
+    } else if (line.startsWith(getStringForType(COMMAND_DAQCMD) + " ")) {
+        return _parseDaqCMDCommand(line, line_count);
+    } else {
+        QString cpy = line;
+        QTextStream line_stream(&cpy);
+        QString cmd;
+        line_stream >> cmd;
+        throw BurnInException("Line " + std::to_string(line_count) + ": Unknown command or missing arguments \"" + cmd.toStdString() + "\"");
+    }
+}
+
+BurnInParallelCommand* CommandProcessor::_parseParallelBlock(QTextStream& in, int& line_count, const VariableRanges& variables) const {
+    int start_line = line_count;
+    BurnInParallelCommand* block = new BurnInParallelCommand();
+    
+    // Devices used by the commands of the block, e.g. a voltage source
+    // together with its output. Output 0 stands for all outputs
+    std::set<std::pair<const void*, int>> devices;
+    
+    try {
+        bool closed = false;
+        while (not in.atEnd()) {
+            ++line_count;
+            QString line = removeLeadingSpace(in.readLine());
             
-        } else if (line.startsWith(getStringForType(COMMAND_CHILLEROUTPUT) + " ")) {
-            list.push_back(_parseChillerOutputCommand(line, line_count));
+            if (line.startsWith("#") or line.isEmpty())
+                continue;
+            if (line.trimmed() == "}") {
+                closed = true;
+                break;
+            }
+            if (line.trimmed().endsWith("{"))
+                throw BurnInException("Line " + std::to_string(line_count) + ": Blocks can not be put into a parallel block");
             
-        } else if (line.startsWith(getStringForType(COMMAND_CHILLERSET) + " ")) {
-            list.push_back(_parseChillerSetCommand(line, line_count));
+            BurnInCommand* command = _parseCommand(line, line_count, variables);
+            block->commands.push_back(command);
             
-        } else if (line.startsWith(getStringForType(COMMAND_DAQCMD) + " ")) {
-            list.push_back(_parseDaqCMDCommand(line, line_count));
-        } else {
-            QTextStream line_stream(&line);
-            QString cmd;
-            line_stream >> cmd;
-            throw BurnInException("Line " + std::to_string(line_count) + ": Unknown command or missing arguments \"" + cmd.toStdString() + "\"");
+            std::pair<const void*, int> device(nullptr, 0);
+            switch (command->getType()) {
+            case COMMAND_VOLTAGESOURCEOUTPUT: {
+                auto cmd = static_cast<BurnInVoltageSourceOutputCommand*>(command);
+                device = std::make_pair(cmd->source, cmd->output);
+                break;
+            }
+            case COMMAND_VOLTAGESOURCESET: {
+                auto cmd = static_cast<BurnInVoltageSourceSetCommand*>(command);
+                device = std::make_pair(cmd->source, cmd->output);
+                break;
+            }
+            case COMMAND_CHILLEROUTPUT:
+                device = std::make_pair(static_cast<BurnInChillerOutputCommand*>(command)->chiller, 0);
+                break;
+            case COMMAND_CHILLERSET:
+                device = std::make_pair(static_cast<BurnInChillerSetCommand*>(command)->chiller, 0);
+                break;
+            case COMMAND_DAQCMD:
+                device = std::make_pair(_controller->getDaqModules()[0], 0);
+                break;
+            case COMMAND_WAIT:
+            case COMMAND_PARALLEL:
+            case COMMAND_REPEAT:
+            case COMMAND_FOR:
+                break;
+            }
+            if (device.first == nullptr)
+                continue;
+            for (const auto& used: devices) {
+                if (used.first == device.first and (used.second == device.second or used.second == 0 or device.second == 0))
+                    throw BurnInException("Line " + std::to_string(line_count) + ": Device already used in the parallel block");
+            }
+            devices.insert(device);
         }
+        
+        if (not closed)
+            throw BurnInException("Line " + std::to_string(start_line) + ": Parallel block is missing its closing }");
+        if (block->commands.empty())
+            throw BurnInException("Line " + std::to_string(start_line) + ": Empty parallel block");
+    } catch (const BurnInException&) {
+        delete block;
+        throw;
     }
     
-    return list;
+    return block;
 }
 
-BurnInWaitCommand* CommandProcessor::_parseWaitCommand(const QString& line, int line_count) const {
+BurnInRepeatCommand* CommandProcessor::_parseRepeatBlock(const QString& line, QTextStream& in, int& line_count, const VariableRanges& variables) const {
+    int start_line = line_count;
+    QRegularExpressionMatch match = QRegularExpression("^repeat\\s+(\\S+)\\s*\\{$").match(line.trimmed());
+    if (not match.hasMatch())
+        throw BurnInException("Line " + std::to_string(line_count) + ": Expected \"repeat <count> {\"");
+    bool ok;
+    unsigned int count = match.captured(1).toUInt(&ok);
+    if (not ok)
+        throw BurnInException("Line " + std::to_string(line_count) + ": Invalid repeat count \"" + match.captured(1).toStdString() + "\"");
+    // Same limit as for the for blocks
+    if (count > static_cast<unsigned int>(std::numeric_limits<int>::max()))
+        throw BurnInException("Line " + std::to_string(line_count) + ": Too many iterations, the loop can run at most "
+            + std::to_string(std::numeric_limits<int>::max()) + " times");
+    
+    BurnInRepeatCommand* command = new BurnInRepeatCommand(count);
+    try {
+        command->commands = _parseBlock(in, line_count, variables, start_line);
+    } catch (const BurnInException&) {
+        delete command;
+        throw;
+    }
+    return command;
+}
+
+BurnInForCommand* CommandProcessor::_parseForBlock(const QString& line, QTextStream& in, int& line_count, const VariableRanges& variables) const {
+    int start_line = line_count;
+    QRegularExpressionMatch match = QRegularExpression(
+        "^for\\s+([A-Za-z_]\\w*)\\s+in\\s+([^:\\s]+):([^:\\s]+):([^:\\s]+)\\s*\\{$").match(line.trimmed());
+    if (not match.hasMatch())
+        throw BurnInException("Line " + std::to_string(line_count) + ": Expected \"for <variable> in <start>:<stop>:<step> {\"");
+    
+    QString variable = match.captured(1);
+    if (variables.count(variable) != 0)
+        throw BurnInException("Line " + std::to_string(line_count) + ": Variable \"" + variable.toStdString() + "\" is already used by an outer loop");
+    double limits[3];
+    for (int i = 0; i < 3; ++i) {
+        bool ok;
+        limits[i] = match.captured(i + 2).toDouble(&ok);
+        if (not ok or not std::isfinite(limits[i]))
+            throw BurnInException("Line " + std::to_string(line_count) + ": Invalid number \"" + match.captured(i + 2).toStdString() + "\"");
+    }
+    
+    // The number of iterations needs to fit into the counters of the
+    // executer
+    if (limits[2] != 0 and std::floor((limits[1] - limits[0]) / limits[2] + 1e-9) >= std::numeric_limits<int>::max())
+        throw BurnInException("Line " + std::to_string(line_count) + ": Too many iterations, the loop can run at most "
+            + std::to_string(std::numeric_limits<int>::max()) + " times");
+    
+    BurnInForCommand* command = new BurnInForCommand(variable, limits[0], limits[1], limits[2]);
+    if (command->getCount() == 0) {
+        delete command;
+        throw BurnInException("Line " + std::to_string(line_count) + ": The step of the loop doesn't lead from start to stop");
+    }
+    
+    // The commands of the loop are checked against all values the
+    // variable takes
+    VariableRanges inner = variables;
+    double last = command->getValue(command->getCount() - 1);
+    inner[variable] = std::make_pair(std::min(command->start, last), std::max(command->start, last));
+    try {
+        command->commands = _parseBlock(in, line_count, inner, start_line);
+    } catch (const BurnInException&) {
+        delete command;
+        throw;
+    }
+    return command;
+}
+
+CommandProcessor::ValueArgument CommandProcessor::_parseValueArgument(const QString& str, int line_count, const VariableRanges& variables, bool* ok) {
+    ValueArgument arg;
+    if (str.startsWith("$")) {
+        arg.variable = str.mid(1);
+        if (arg.variable.startsWith("{") and arg.variable.endsWith("}"))
+            arg.variable = arg.variable.mid(1, arg.variable.length() - 2);
+        if (variables.count(arg.variable) == 0)
+            throw BurnInException("Line " + std::to_string(line_count) + ": Unknown variable \"" + arg.variable.toStdString() + "\"");
+        arg.value = 0;
+        arg.min = variables.at(arg.variable).first;
+        arg.max = variables.at(arg.variable).second;
+        *ok = true;
+    } else {
+        arg.value = str.toDouble(ok);
+        arg.min = arg.value;
+        arg.max = arg.value;
+    }
+    return arg;
+}
+
+BurnInWaitCommand* CommandProcessor::_parseWaitCommand(const QString& line, int line_count, const VariableRanges& variables) const {
     int cmdlen = getStringForType(COMMAND_WAIT).length();
     QString args = line.right(line.length() - cmdlen - 1);
     QTextStream line_stream(&args);
     
     QString wait_str;
-    unsigned int wait;
     bool ok;
     
     line_stream >> wait_str;
-    wait = wait_str.toUInt(&ok);
+    if (wait_str.startsWith("$")) {
+        ValueArgument arg = _parseValueArgument(wait_str, line_count, variables, &ok);
+        if (arg.min < 0)
+            throw BurnInException("Line " + std::to_string(line_count) + ": Variable \"" + arg.variable.toStdString() + "\" can be negative and can not be used as wait value");
+        return new BurnInWaitCommand(0, arg.variable);
+    }
+    
+    unsigned int wait = wait_str.toUInt(&ok);
     if (not ok)
         throw BurnInException("Line " + std::to_string(line_count) + ": Invalid wait value \"" + wait_str.toStdString() + "\"");
     
@@ -231,7 +491,7 @@ BurnInVoltageSourceOutputCommand* CommandProcessor::_parseVoltageSourceOutputCom
     return new BurnInVoltageSourceOutputCommand(source, sourceName, output, on);
 }
 
-BurnInVoltageSourceSetCommand* CommandProcessor::_parseVoltageSourceSetCommand(const QString& line, int line_count) const {
+BurnInVoltageSourceSetCommand* CommandProcessor::_parseVoltageSourceSetCommand(const QString& line, int line_count, const VariableRanges& variables) const {
     int cmdlen = getStringForType(COMMAND_VOLTAGESOURCESET).length();
     QString args = line.right(line.length() - cmdlen - 1);
     QTextStream line_stream(&args);
@@ -241,18 +501,17 @@ BurnInVoltageSourceSetCommand* CommandProcessor::_parseVoltageSourceSetCommand(c
     PowerControlClass* source;
     QString value_str;
     bool ok;
-    double value;
     
     sourceName = _getQuotedString(line_stream);
     source = _parseVoltageSourceName(sourceName, line_count);
     output = _parseVoltageSourceOutput(line_stream, line_count, source);
     
     line_stream >> value_str;
-    value = value_str.toDouble(&ok);
-    if (not ok or std::isnan(value) or value < -1000 or value > 1000)
+    ValueArgument arg = _parseValueArgument(value_str, line_count, variables, &ok);
+    if (not ok or std::isnan(arg.value) or arg.min < -1000 or arg.max > 1000)
         throw BurnInException("Line " + std::to_string(line_count) + ": Invalid voltage value " + value_str.toStdString() + "");
         
-    return new BurnInVoltageSourceSetCommand(source, sourceName, output, value);
+    return new BurnInVoltageSourceSetCommand(source, sourceName, output, arg.value, arg.variable);
 }
 
 BurnInChillerOutputCommand* CommandProcessor::_parseChillerOutputCommand(const QString& line, int line_count) const {
@@ -267,7 +526,7 @@ BurnInChillerOutputCommand* CommandProcessor::_parseChillerOutputCommand(const Q
     return new BurnInChillerOutputCommand(chiller, chillerName, on);
 }
 
-BurnInChillerSetCommand* CommandProcessor::_parseChillerSetCommand(const QString& line, int line_count) const {
+BurnInChillerSetCommand* CommandProcessor::_parseChillerSetCommand(const QString& line, int line_count, const VariableRanges& variables) const {
     int cmdlen = getStringForType(COMMAND_CHILLERSET).length();
     QString args = line.right(line.length() - cmdlen - 1);
     QTextStream line_stream(&args);
@@ -275,15 +534,14 @@ BurnInChillerSetCommand* CommandProcessor::_parseChillerSetCommand(const QString
     QString chillerName = _getQuotedString(line_stream);
     Chiller* chiller = _parseChillerName(chillerName, line_count);
     QString value_str;
-    double value;
     bool ok;
     
     line_stream >> value_str;
-    value = value_str.toDouble(&ok);
-    if (not ok or std::isnan(value) or value < JulaboFP50::FP50LowerTempLimit or value >JulaboFP50::FP50UpperTempLimit)
+    ValueArgument arg = _parseValueArgument(value_str, line_count, variables, &ok);
+    if (not ok or std::isnan(arg.value) or arg.min < JulaboFP50::FP50LowerTempLimit or arg.max > JulaboFP50::FP50UpperTempLimit)
         throw BurnInException("Line " + std::to_string(line_count) + ": Invalid temperature value " + value_str.toStdString() + "");
     
-    return new BurnInChillerSetCommand(chiller, chillerName, value);
+    return new BurnInChillerSetCommand(chiller, chillerName, arg.value, arg.variable);
 }
 
 BurnInDAQCommand* CommandProcessor::_parseDaqCMDCommand(const QString& line, int line_count) const {
@@ -345,13 +603,7 @@ GenericInstrumentClass* CommandProcessor::_parseDeviceName(const QString& devNam
 }
 
 PowerControlClass* CommandProcessor::_parseVoltageSourceName(const QString& devName, int line_count) const {
-    GenericInstrumentClass* dev = _parseDeviceName(devName, line_count);
-    PowerControlClass* source = nullptr;
-    
-    for (auto& source2: _controller->getVoltageSources()) {
-        if (dev == source2)
-            source = source2;
-    }
+    PowerControlClass* source = dynamic_cast<PowerControlClass*>(_parseDeviceName(devName, line_count));
     if (source == nullptr)
         throw BurnInException("Line " + std::to_string(line_count) + ": Not a voltage source \"" + devName.toStdString() + "\"");
         
@@ -359,13 +611,7 @@ PowerControlClass* CommandProcessor::_parseVoltageSourceName(const QString& devN
 }
 
 Chiller* CommandProcessor::_parseChillerName(const QString& devName, int line_count) const {
-    GenericInstrumentClass* dev = _parseDeviceName(devName, line_count);
-    Chiller* chiller = nullptr;
-    
-    for (auto& chiller2: _controller->getChillers()) {
-        if (dev == chiller2)
-            chiller = chiller2;
-    }
+    Chiller* chiller = dynamic_cast<Chiller*>(_parseDeviceName(devName, line_count));
     if (chiller == nullptr)
         throw BurnInException("Line " + std::to_string(line_count) + ": Not a chiller \"" + devName.toStdString() + "\"");
         
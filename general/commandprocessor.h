@@ -5,6 +5,8 @@
 #include <QString>
 #include <QVector>
 #include <QTextStream>
+#include <map>
+#include <utility>
 #include "general/systemcontrollerclass.h"
 #include "general/burnincommand.h"
 
@@ -29,13 +31,31 @@ public slots:
 private:
     const SystemControllerClass* _controller;
     
+    // Loop variables usable at a line, with the smallest and the largest
+    // value they take
+    typedef std::map<QString, std::pair<double, double>> VariableRanges;
+    
+    // A number or a loop variable like $v given as argument
+    struct ValueArgument {
+        double value;
+        QString variable; // Empty for numbers
+        double min; // Range of the values taken, value for numbers
+        double max;
+    };
+    
     QVector<BurnInCommand*> _parseCommands(QTextStream& in) const;
-    BurnInWaitCommand* _parseWaitCommand(const QString& line, int line_count) const;
+    QVector<BurnInCommand*> _parseBlock(QTextStream& in, int& line_count, const VariableRanges& variables, int start_line) const;
+    BurnInCommand* _parseCommand(const QString& line, int line_count, const VariableRanges& variables) const;
+    BurnInParallelCommand* _parseParallelBlock(QTextStream& in, int& line_count, const VariableRanges& variables) const;
+    BurnInRepeatCommand* _parseRepeatBlock(const QString& line, QTextStream& in, int& line_count, const VariableRanges& variables) const;
+    BurnInForCommand* _parseForBlock(const QString& line, QTextStream& in, int& line_count, const VariableRanges& variables) const;
+    BurnInWaitCommand* _parseWaitCommand(const QString& line, int line_count, const VariableRanges& variables) const;
     BurnInVoltageSourceOutputCommand* _parseVoltageSourceOutputCommand(const QString& line, int line_count) const;
-    BurnInVoltageSourceSetCommand* _parseVoltageSourceSetCommand(const QString& line, int line_count) const;
+    BurnInVoltageSourceSetCommand* _parseVoltageSourceSetCommand(const QString& line, int line_count, const VariableRanges& variables) const;
     BurnInChillerOutputCommand* _parseChillerOutputCommand(const QString& line, int line_count) const;
-    BurnInChillerSetCommand* _parseChillerSetCommand(const QString& line, int line_count) const;
+    BurnInChillerSetCommand* _parseChillerSetCommand(const QString& line, int line_count, const VariableRanges& variables) const;
     BurnInDAQCommand* _parseDaqCMDCommand(const QString& line, int line_count) const;
+    static ValueArgument _parseValueArgument(const QString& str, int line_count, const VariableRanges& variables, bool* ok);
     
     static QString _escapeName(const QString& name);
     static QString _getQuotedString(QTextStream& in);
@@ -55,9 +75,15 @@ private:
         void handleCommand(BurnInChillerOutputCommand& command) override;
         void handleCommand(BurnInChillerSetCommand& command) override;
         void handleCommand(BurnInDAQCommand& command) override;
+        void handleCommand(BurnInParallelCommand& command) override;
+        void handleCommand(BurnInRepeatCommand& command) override;
+        void handleCommand(BurnInForCommand& command) override;
         
     private:
+        void _saveBlock(const QVector<BurnInCommand*>& commands);
+        
         QTextStream* out;
+        QString indent; // Put in front of the commands of a block
         
     };
 };
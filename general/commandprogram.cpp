@@ -0,0 +1,549 @@
+#include "commandprogram.h"
+
+#include "general/BurnInException.h"
+#include "general/commandprocessor.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QStandardPaths>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+const double VOLTAGE_LIMIT = 1000; // V, in both directions
+
+// Turns a command list into the instructions of a program
+class CommandCompiler : public AbstractCommandHandler {
+public:
+    CommandCompiler(CommandProgram& program, const SystemControllerClass* controller);
+
+    void compile(const QVector<BurnInCommand*>& commands);
+
+    void handleCommand(BurnInWaitCommand& command) override;
+    void handleCommand(BurnInVoltageSourceOutputCommand& command) override;
+    void handleCommand(BurnInVoltageSourceSetCommand& command) override;
+    void handleCommand(BurnInChillerOutputCommand& command) override;
+    void handleCommand(BurnInChillerSetCommand& command) override;
+    void handleCommand(BurnInDAQCommand& command) override;
+    void handleCommand(BurnInParallelCommand& command) override;
+    void handleCommand(BurnInRepeatCommand& command) override;
+    void handleCommand(BurnInForCommand& command) override;
+
+private:
+    // Loop variable visible at the current command
+    struct Scope {
+        QString name;
+        int slot;
+        double min;
+        double max;
+    };
+
+    CommandProgram& _program;
+    const SystemControllerClass* _controller;
+    int _command;
+    std::vector<Scope> _scopes;
+    QHash<PowerControlClass*, int> _sourceIndices;
+    QHash<Chiller*, int> _chillerIndices;
+
+    Instruction _makeInstruction(OpCode op) const;
+
+    /**
+     * Set the value of an instruction and check it against the limits
+     * @param variable Name of the loop variable or empty for value
+     */
+    void _setValue(Instruction& instruction, double value, const QString& variable, double min, double max, const char* what);
+    void _compileLoop(Instruction loop, const QVector<BurnInCommand*>& commands);
+    int _getSourceIndex(PowerControlClass* source, int output);
+    int _getChillerIndex(Chiller* chiller);
+    [[noreturn]] void _fail(const std::string& message) const;
+
+    double _estimate(int begin, int end, std::vector<double>& variables) const;
+};
+
+CommandCompiler::CommandCompiler(CommandProgram& program, const SystemControllerClass* controller) :
+    _program(program),
+    _controller(controller),
+    _command(0)
+{
+}
+
+void CommandCompiler::compile(const QVector<BurnInCommand*>& commands) {
+    for (_command = 0; _command < commands.size(); ++_command)
+        commands[_command]->accept(*this);
+    _program._commandCount = commands.size();
+
+    std::vector<double> variables(_program._variables.size(), 0);
+    _program._estimatedDuration = _estimate(0, _program._instructions.size(), variables);
+}
+
+Instruction CommandCompiler::_makeInstruction(OpCode op) const {
+    Instruction instruction;
+    instruction.op = op;
+    instruction.command = _command;
+    instruction.device = -1;
+    instruction.output = 0;
+    instruction.variable = -1;
+    instruction.count = 0;
+    instruction.jump = -1;
+    instruction.value = 0;
+    instruction.step = 0;
+    return instruction;
+}
+
+void CommandCompiler::_fail(const std::string& message) const {
+    throw BurnInException("Command " + std::to_string(_command + 1) + ": " + message);
+}
+
+void CommandCompiler::_setValue(Instruction& instruction, double value, const QString& variable, double min, double max, const char* what) {
+    double low = value;
+    double high = value;
+    if (not variable.isEmpty()) {
+        auto scope = std::find_if(_scopes.rbegin(), _scopes.rend(), [&variable](const Scope& scope) {
+            return scope.name == variable;
+        });
+        if (scope == _scopes.rend())
+            _fail("Unknown variable \"" + variable.toStdString() + "\"");
+        instruction.variable = scope->slot;
+        low = scope->min;
+        high = scope->max;
+    }
+    if (low < min or high > max)
+        _fail(std::string("The ") + what + " needs to be between " + QString::number(min).toStdString()
+            + " and " + QString::number(max).toStdString());
+    instruction.value = value;
+}
+
+int CommandCompiler::_getSourceIndex(PowerControlClass* source, int output) {
+    if (output < 0 or output > source->getNumOutputs())
+        _fail("The source has no output " + std::to_string(output));
+    if (_controller->hasFailed(source))
+        _fail(_controller->getId(source) + " failed to initialize");
+
+    auto it = _sourceIndices.find(source);
+    if (it != _sourceIndices.end())
+        return it.value();
+    int index = _program._sources.size();
+    _program._sources.push_back(source);
+    _program._sourceIds.append(QString::fromStdString(_controller->getId(source)));
+    _sourceIndices[source] = index;
+    return index;
+}
+
+int CommandCompiler::_getChillerIndex(Chiller* chiller) {
+    if (chiller == nullptr)
+        _fail("No chiller connected");
+    if (_controller->hasFailed(chiller))
+        _fail(_controller->getId(chiller) + " failed to initialize");
+
+    auto it = _chillerIndices.find(chiller);
+    if (it != _chillerIndices.end())
+        return it.value();
+    int index = _program._chillers.size();
+    _program._chillers.push_back(chiller);
+    _program._chillerIds.append(QString::fromStdString(_controller->getId(chiller)));
+    _chillerIndices[chiller] = index;
+    return index;
+}
+
+void CommandCompiler::handleCommand(BurnInWaitCommand& command) {
+    Instruction instruction = _makeInstruction(OP_WAIT);
+    _setValue(instruction, command.wait, command.variable, 0, std::numeric_limits<double>::max(), "time to wait");
+    _program._instructions.push_back(instruction);
+}
+
+void CommandCompiler::handleCommand(BurnInVoltageSourceOutputCommand& command) {
+    Instruction instruction = _makeInstruction(OP_VOLTAGESOURCEOUTPUT);
+    instruction.device = _getSourceIndex(command.source, command.output);
+    instruction.output = command.output;
+    instruction.value = command.on ? 1 : 0;
+    _program._instructions.push_back(instruction);
+}
+
+void CommandCompiler::handleCommand(BurnInVoltageSourceSetCommand& command) {
+    Instruction instruction = _makeInstruction(OP_VOLTAGESOURCESET);
+    instruction.device = _getSourceIndex(command.source, command.output);
+    instruction.output = command.output;
+    _setValue(instruction, command.value, command.variable, -VOLTAGE_LIMIT, VOLTAGE_LIMIT, "voltage");
+    _program._instructions.push_back(instruction);
+}
+
+void CommandCompiler::handleCommand(BurnInChillerOutputCommand& command) {
+    Instruction instruction = _makeInstruction(OP_CHILLEROUTPUT);
+    instruction.device = _getChillerIndex(command.chiller);
+    instruction.value = command.on ? 1 : 0;
+    _program._instructions.push_back(instruction);
+}
+
+void CommandCompiler::handleCommand(BurnInChillerSetCommand& command) {
+    Instruction instruction = _makeInstruction(OP_CHILLERSET);
+    instruction.device = _getChillerIndex(command.chiller);
+    _setValue(instruction, command.value, command.variable,
+        command.chiller->GetMinTemp(), command.chiller->GetMaxTemp(), "temperature");
+    _program._instructions.push_back(instruction);
+}
+
+void CommandCompiler::handleCommand(BurnInDAQCommand& command) {
+    if (_controller->getDaqModules().empty())
+        _fail("No DAQ module connected");
+    if (_controller->hasFailed(_controller->getDaqModules()[0]))
+        _fail(_controller->getId(_controller->getDaqModules()[0]) + " failed to initialize");
+
+    Instruction instruction = _makeInstruction(OP_DAQCMD);
+    instruction.device = _program._daqExecNames.size();
+    _program._daqExecNames.append(command.execName);
+    _program._daqOpts.append(command.opts);
+    _program._instructions.push_back(instruction);
+}
+
+void CommandCompiler::handleCommand(BurnInParallelCommand& command) {
+    Instruction instruction = _makeInstruction(OP_PARALLEL);
+    instruction.count = command.commands.size();
+    _program._instructions.push_back(instruction);
+    for (const auto& subcommand: command.commands) {
+        if (subcommand->getType() == COMMAND_PARALLEL or subcommand->getType() == COMMAND_REPEAT
+                or subcommand->getType() == COMMAND_FOR)
+            _fail("Blocks can not be put into a parallel block");
+        subcommand->accept(*this);
+    }
+}
+
+void CommandCompiler::handleCommand(BurnInRepeatCommand& command) {
+    Instruction loop = _makeInstruction(OP_LOOP);
+    loop.count = static_cast<qint32>(std::min<unsigned int>(command.count, std::numeric_limits<qint32>::max()));
+    _compileLoop(loop, command.commands);
+}
+
+void CommandCompiler::handleCommand(BurnInForCommand& command) {
+    unsigned int count = command.getCount();
+    if (count == 0)
+        _fail("The step of the loop doesn't lead from start to stop");
+
+    Instruction loop = _makeInstruction(OP_LOOP);
+    loop.count = static_cast<qint32>(std::min<unsigned int>(count, std::numeric_limits<qint32>::max()));
+    loop.value = command.start;
+    loop.step = command.step;
+    loop.variable = _program._variables.size();
+    _program._variables.append(command.variable);
+
+    double last = command.getValue(count - 1);
+    _scopes.push_back({command.variable, loop.variable, std::min(command.start, last), std::max(command.start, last)});
+    _compileLoop(loop, command.commands);
+    _scopes.pop_back();
+}
+
+void CommandCompiler::_compileLoop(Instruction loop, const QVector<BurnInCommand*>& commands) {
+    int begin = _program._instructions.size();
+    _program._instructions.push_back(loop);
+    for (const auto& command: commands)
+        command->accept(*this);
+
+    Instruction next = _makeInstruction(OP_NEXT);
+    next.jump = begin;
+    _program._instructions.push_back(next);
+    _program._instructions[begin].jump = _program._instructions.size();
+}
+
+double CommandCompiler::_estimate(int begin, int end, std::vector<double>& variables) const {
+    const QVector<Instruction>& instructions = _program._instructions;
+    double total = 0;
+    int pc = begin;
+    while (pc < end) {
+        const Instruction& instruction = instructions[pc];
+        switch (instruction.op) {
+        case OP_WAIT:
+            total += instruction.variable >= 0 ? variables[instruction.variable] : instruction.value;
+            ++pc;
+            break;
+        case OP_PARALLEL: {
+            // Only waits take time, the longest one counts
+            double longest = 0;
+            for (int i = pc + 1; i <= pc + instruction.count; ++i)
+                longest = std::max(longest, _estimate(i, i + 1, variables));
+            total += longest;
+            pc += instruction.count + 1;
+            break;
+        }
+        case OP_LOOP: {
+            int bodyBegin = pc + 1;
+            int bodyEnd = instruction.jump - 1; // Without the NEXT
+            bool usesVariable = instruction.variable >= 0 and std::any_of(
+                    instructions.begin() + bodyBegin, instructions.begin() + bodyEnd, [&instruction](const Instruction& other) {
+                return other.variable == instruction.variable;
+            });
+            if (usesVariable) {
+                for (qint32 i = 0; i < instruction.count; ++i) {
+                    variables[instruction.variable] = instruction.value + i * instruction.step;
+                    total += _estimate(bodyBegin, bodyEnd, variables);
+                }
+            } else
+                total += instruction.count * _estimate(bodyBegin, bodyEnd, variables);
+            pc = instruction.jump;
+            break;
+        }
+        case OP_VOLTAGESOURCEOUTPUT:
+        case OP_VOLTAGESOURCESET:
+        case OP_CHILLEROUTPUT:
+        case OP_CHILLERSET:
+        case OP_DAQCMD:
+        case OP_NEXT:
+            ++pc;
+            break;
+        }
+    }
+    return total;
+}
+
+CommandProgram::CommandProgram() {
+    _commandCount = 0;
+    _estimatedDuration = 0;
+}
+
+CommandProgram CommandProgram::compile(const QVector<BurnInCommand*>& commands, const SystemControllerClass* controller) {
+    CommandProgram program;
+    CommandCompiler compiler(program, controller);
+    compiler.compile(commands);
+    return program;
+}
+
+CommandProgram CommandProgram::compileFile(const QString& filePath, const SystemControllerClass* controller) {
+    QFile file(filePath);
+    if (not file.open(QIODevice::ReadOnly | QIODevice::Text))
+        throw BurnInException("Could not open file");
+    QByteArray source = file.readAll();
+    file.close();
+
+    QByteArray hash = QCryptographicHash::hash(source, QCryptographicHash::Sha1);
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/programs";
+    QString cachePath = cacheDir + "/" + QString::fromLatin1(hash.toHex()) + ".bin";
+
+    CommandProgram program;
+    if (program.load(cachePath, hash, controller)) {
+        qDebug("Loaded compiled commands from %s", cachePath.toLocal8Bit().constData());
+        return program;
+    }
+
+    CommandProcessor processor(controller);
+    QVector<BurnInCommand*> commands = processor.getCommandListFromString(QString::fromUtf8(source));
+    try {
+        program = compile(commands, controller);
+    } catch (const BurnInException&) {
+        qDeleteAll(commands);
+        throw;
+    }
+    qDeleteAll(commands);
+
+    if (not QDir().mkpath(cacheDir) or not program.save(cachePath, hash))
+        qWarning("Could not cache compiled commands in %s", cacheDir.toLocal8Bit().constData());
+    return program;
+}
+
+const QVector<Instruction>& CommandProgram::getInstructions() const {
+    return _instructions;
+}
+
+PowerControlClass* CommandProgram::getSource(int index) const {
+    return _sources[index];
+}
+
+Chiller* CommandProgram::getChiller(int index) const {
+    return _chillers[index];
+}
+
+QString CommandProgram::getDaqExecName(int index) const {
+    return _daqExecNames[index];
+}
+
+QString CommandProgram::getDaqOpts(int index) const {
+    return _daqOpts[index];
+}
+
+QString CommandProgram::getVariableName(int slot) const {
+    return _variables[slot];
+}
+
+int CommandProgram::getVariableCount() const {
+    return _variables.size();
+}
+
+int CommandProgram::getCommandCount() const {
+    return _commandCount;
+}
+
+double CommandProgram::getEstimatedDuration() const {
+    return _estimatedDuration;
+}
+
+bool CommandProgram::save(const QString& path, const QByteArray& sourceHash) const {
+    QFile file(path);
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    // Devices are stored by their ids and resolved again when loading
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << FILE_MAGIC << FILE_VERSION << sourceHash
+        << static_cast<qint32>(_commandCount) << _estimatedDuration
+        << _sourceIds << _chillerIds << _daqExecNames << _daqOpts << _variables
+        << static_cast<qint32>(_instructions.size());
+    for (const auto& instruction: _instructions) {
+        out << static_cast<quint8>(instruction.op) << instruction.command << instruction.device
+            << instruction.output << instruction.variable << instruction.count << instruction.jump
+            << instruction.value << instruction.step;
+    }
+
+    return out.status() == QDataStream::Ok;
+}
+
+bool CommandProgram::load(const QString& path, const QByteArray& sourceHash, const SystemControllerClass* controller) {
+    QFile file(path);
+    if (not file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, version;
+    QByteArray hash;
+    in >> magic >> version >> hash;
+    if (magic != FILE_MAGIC or version != FILE_VERSION or hash != sourceHash)
+        return false;
+
+    CommandProgram program;
+    qint32 commandCount, instructionCount;
+    in >> commandCount >> program._estimatedDuration >> program._sourceIds >> program._chillerIds
+       >> program._daqExecNames >> program._daqOpts >> program._variables >> instructionCount;
+    if (in.status() != QDataStream::Ok or instructionCount < 0)
+        return false;
+    program._commandCount = commandCount;
+
+    // The hardware description might have changed since
+    for (const auto& id: program._sourceIds) {
+        PowerControlClass* source = dynamic_cast<PowerControlClass*>(controller->getDeviceById(id.toStdString()));
+        if (source == nullptr or controller->hasFailed(source))
+            return false;
+        program._sources.push_back(source);
+    }
+    for (const auto& id: program._chillerIds) {
+        Chiller* chiller = dynamic_cast<Chiller*>(controller->getDeviceById(id.toStdString()));
+        if (chiller == nullptr or controller->hasFailed(chiller))
+            return false;
+        program._chillers.push_back(chiller);
+    }
+    if (not program._daqExecNames.empty() and (controller->getDaqModules().empty() or controller->hasFailed(controller->getDaqModules()[0])))
+        return false;
+
+    program._instructions.reserve(instructionCount);
+    for (qint32 i = 0; i < instructionCount; ++i) {
+        Instruction instruction;
+        quint8 op;
+        in >> op >> instruction.command >> instruction.device >> instruction.output
+           >> instruction.variable >> instruction.count >> instruction.jump
+           >> instruction.value >> instruction.step;
+        if (op > OP_NEXT)
+            return false;
+        instruction.op = static_cast<OpCode>(op);
+        program._instructions.push_back(instruction);
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    // Don't trust the indices of a damaged file
+    for (const auto& instruction: program._instructions) {
+        if (instruction.op == OP_VOLTAGESOURCEOUTPUT or instruction.op == OP_VOLTAGESOURCESET) {
+            if (instruction.device < 0 or instruction.device >= program._sources.size()
+                    or instruction.output > program._sources[instruction.device]->getNumOutputs())
+                return false;
+        } else if (instruction.op == OP_CHILLEROUTPUT or instruction.op == OP_CHILLERSET) {
+            if (instruction.device < 0 or instruction.device >= program._chillers.size())
+                return false;
+        } else if (instruction.op == OP_DAQCMD) {
+            if (instruction.device < 0 or instruction.device >= program._daqExecNames.size())
+                return false;
+        }
+        if (instruction.variable < -1 or instruction.variable >= program._variables.size())
+            return false;
+    }
+    if (not program._hasValidStructure())
+        return false;
+    // The id might belong to a device with other limits now
+    if (not program._hasValuesInRange())
+        return false;
+
+    *this = program;
+    return true;
+}
+
+bool CommandProgram::_hasValidStructure() const {
+    // The executer follows jumps and counts without checking them
+    int size = _instructions.size();
+    std::vector<int> loops; // Indices of the LOOPs not closed yet
+    for (int pc = 0; pc < size; ++pc) {
+        const Instruction& instruction = _instructions[pc];
+        if (instruction.jump < -1 or instruction.jump > size)
+            return false;
+        switch (instruction.op) {
+        case OP_PARALLEL:
+            if (instruction.count < 0 or pc + instruction.count >= size)
+                return false;
+            for (int i = pc + 1; i <= pc + instruction.count; ++i) {
+                OpCode op = _instructions[i].op;
+                if (op == OP_PARALLEL or op == OP_LOOP or op == OP_NEXT)
+                    return false;
+            }
+            break;
+        case OP_LOOP:
+            if (instruction.count < 0 or instruction.jump < pc + 2)
+                return false;
+            loops.push_back(pc);
+            break;
+        case OP_NEXT:
+            if (loops.empty() or instruction.jump != loops.back()
+                    or _instructions[loops.back()].jump != pc + 1)
+                return false;
+            loops.pop_back();
+            break;
+        default:
+            break;
+        }
+    }
+    return loops.empty();
+}
+
+bool CommandProgram::_hasValuesInRange() const {
+    // Range of every loop variable over all iterations
+    std::vector<std::pair<double, double>> ranges(_variables.size());
+    for (const auto& instruction: _instructions) {
+        if (instruction.op != OP_LOOP or instruction.variable < 0 or instruction.count == 0)
+            continue;
+        double last = instruction.value + (instruction.count - 1) * instruction.step;
+        ranges[instruction.variable] = std::make_pair(std::min(instruction.value, last), std::max(instruction.value, last));
+    }
+
+    for (const auto& instruction: _instructions) {
+        double low = instruction.value;
+        double high = instruction.value;
+        if (instruction.op != OP_LOOP and instruction.variable >= 0) {
+            low = ranges[instruction.variable].first;
+            high = ranges[instruction.variable].second;
+        }
+        switch (instruction.op) {
+        case OP_WAIT:
+            if (low < 0)
+                return false;
+            break;
+        case OP_VOLTAGESOURCESET:
+            if (low < -VOLTAGE_LIMIT or high > VOLTAGE_LIMIT)
+                return false;
+            break;
+        case OP_CHILLERSET:
+            if (low < _chillers[instruction.device]->GetMinTemp() or high > _chillers[instruction.device]->GetMaxTemp())
+                return false;
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,125 @@
+#ifndef COMMANDPROGRAM_H
+#define COMMANDPROGRAM_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QByteArray>
+#include "general/burnincommand.h"
+#include "general/systemcontrollerclass.h"
+
+enum OpCode : quint8 {
+    OP_WAIT,
+    OP_VOLTAGESOURCEOUTPUT,
+    OP_VOLTAGESOURCESET,
+    OP_CHILLEROUTPUT,
+    OP_CHILLERSET,
+    OP_DAQCMD,
+    OP_PARALLEL, // The next count instructions run in parallel
+    OP_LOOP, // Start of a repeat or for block
+    OP_NEXT // End of a repeat or for block
+};
+
+// One step of a compiled command list. The meaning of the fields
+// depends on the op code.
+struct Instruction {
+    OpCode op;
+    qint32 command; // Index of the command in the list it was compiled from
+    qint32 device; // Index into the sources, chillers or DAQ calls of the program
+    qint32 output; // Of a voltage source, 0 for all outputs
+    qint32 variable; // Slot of the loop variable giving value, -1 if none
+    qint32 count; // PARALLEL: number of instructions, LOOP: number of iterations
+    qint32 jump; // LOOP: index after its NEXT, NEXT: index of its LOOP
+    double value; // Seconds to wait, voltage, temperature, 1 for on, start of a for block
+    double step; // LOOP: added to the variable every iteration
+};
+
+// Command list compiled to a flat array of instructions. The devices
+// are resolved and the values are checked against the limits of the
+// devices once when compiling, so nothing is looked up while running.
+class CommandProgram {
+public:
+    CommandProgram();
+
+    /**
+     * Compile a command list
+     * @param commands The list
+     * @param controller Controller owning the devices used by the commands
+     * @throw BurnInException if a value is out of the range of its device
+     */
+    static CommandProgram compile(const QVector<BurnInCommand*>& commands, const SystemControllerClass* controller);
+
+    /**
+     * Compile a command file. The program is cached next to the file
+     * and taken from the cache as long as neither the file nor the
+     * devices used changed.
+     * @throw BurnInException if the file can't be read or is invalid
+     */
+    static CommandProgram compileFile(const QString& filePath, const SystemControllerClass* controller);
+
+    const QVector<Instruction>& getInstructions() const;
+    PowerControlClass* getSource(int index) const;
+    Chiller* getChiller(int index) const;
+    QString getDaqExecName(int index) const;
+    QString getDaqOpts(int index) const;
+    QString getVariableName(int slot) const;
+    int getVariableCount() const;
+
+    /**
+     * @return Number of commands of the list the program was compiled from
+     */
+    int getCommandCount() const;
+
+    /**
+     * @return Estimated time the program runs, in seconds. Only counts
+     * waits, not the time the devices need to reach their values.
+     */
+    double getEstimatedDuration() const;
+
+    /**
+     * Write the program to a file
+     * @param sourceHash Hash of the source the program was compiled from
+     * @return false if the file couldn't be written
+     */
+    bool save(const QString& path, const QByteArray& sourceHash) const;
+
+    /**
+     * Read a program written by save
+     * @param sourceHash Hash the source needs to have
+     * @return false if the file couldn't be read, belongs to another
+     *     source or uses devices the controller doesn't have
+     */
+    bool load(const QString& path, const QByteArray& sourceHash, const SystemControllerClass* controller);
+
+private:
+    friend class CommandCompiler;
+
+    /**
+     * @return false if jumps, counts or the nesting of the loops would
+     *     make the executer leave the instructions
+     */
+    bool _hasValidStructure() const;
+
+    /**
+     * @return false if a value, including every value a loop variable
+     *     takes, is out of the limits of its device. Run after the
+     *     devices were resolved
+     */
+    bool _hasValuesInRange() const;
+
+    QVector<Instruction> _instructions;
+    QVector<PowerControlClass*> _sources;
+    QVector<Chiller*> _chillers;
+    QStringList _sourceIds; // Of the controller, to resolve the devices after loading
+    QStringList _chillerIds;
+    QStringList _daqExecNames;
+    QStringList _daqOpts;
+    QStringList _variables;
+    int _commandCount;
+    double _estimatedDuration;
+
+    static const quint32 FILE_MAGIC = 0x4255524e; // "BURN"
+    static const quint32 FILE_VERSION = 1;
+};
+
+#endif // COMMANDPROGRAM_H
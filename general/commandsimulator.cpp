@@ -0,0 +1,259 @@
+#include "commandsimulator.h"
+
+#include "devices/power/controlkeithleypower.h"
+
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+CommandSimulator::CommandSimulator(const CommandProgram& program, const SystemControllerClass* controller) :
+    _program(program),
+    _controller(controller)
+{
+    _time = 0;
+}
+
+double CommandSimulator::_getRate(const SystemControllerClass* controller, const GenericInstrumentClass* device, const std::string& name, double defaultValue) {
+    std::string str = controller->getAttribute(device, name);
+    if (str.empty())
+        return defaultValue;
+    bool ok;
+    double rate = QString::fromStdString(str).toDouble(&ok);
+    if (not ok or rate < 0) {
+        qWarning("Invalid %s \"%s\" of %s", name.c_str(), str.c_str(), controller->getId(device).c_str());
+        return defaultValue;
+    }
+    return rate;
+}
+
+SimulationResult CommandSimulator::run() {
+    _time = 0;
+    _result = SimulationResult();
+    _result.peakHighVoltage = 0;
+    _result.minTemperature = std::numeric_limits<double>::quiet_NaN();
+    _result.maxTemperature = std::numeric_limits<double>::quiet_NaN();
+    _result.daqCommands = 0;
+
+    // All devices start switched off, the sources with the voltages
+    // they are set to
+    _sources.clear();
+    std::vector<PowerControlClass*> highVoltageSources = _controller->getHighVoltageSources();
+    for (const auto& source: _controller->getVoltageSources()) {
+        double defaultRate = 0;
+        if (dynamic_cast<ControlKeithleyPower*>(source) != nullptr)
+            defaultRate = ControlKeithleyPower::SWEEP_STEP * 1000 / ControlKeithleyPower::SWEEP_INTERVAL;
+        SourceModel& model = _sources[source];
+        model.rampRate = _getRate(_controller, source, "ramprate", defaultRate);
+        model.highVoltage = std::find(highVoltageSources.begin(), highVoltageSources.end(), source) != highVoltageSources.end();
+        for (int i = 1; i <= source->getNumOutputs(); ++i)
+            model.outputs.push_back({source->getVolt(i), 0, false});
+    }
+    _chillers.clear();
+    for (const auto& chiller: _controller->getChillers()) {
+        ChillerModel& model = _chillers[chiller];
+        model.heatingRate = _getRate(_controller, chiller, "heatingrate", DEFAULT_HEATING_RATE) / 60;
+        model.coolingRate = _getRate(_controller, chiller, "coolingrate", DEFAULT_COOLING_RATE) / 60;
+        model.bath = _getRate(_controller, chiller, "starttemperature", DEFAULT_START_TEMPERATURE);
+        model.target = model.bath;
+        model.on = false;
+        if (std::isnan(_result.minTemperature) or model.bath < _result.minTemperature)
+            _result.minTemperature = model.bath;
+        if (std::isnan(_result.maxTemperature) or model.bath > _result.maxTemperature)
+            _result.maxTemperature = model.bath;
+    }
+
+    // Same control flow as the executer
+    const QVector<Instruction>& instructions = _program.getInstructions();
+    std::vector<double> variables(_program.getVariableCount(), 0);
+    std::vector<std::pair<int, qint32>> loops; // Index of the LOOP instruction, iteration
+    int pc = 0;
+    while (pc < instructions.size()) {
+        const Instruction& instruction = instructions[pc];
+        switch (instruction.op) {
+        case OP_LOOP:
+            if (instruction.count == 0) {
+                pc = instruction.jump;
+                break;
+            }
+            loops.emplace_back(pc, 0);
+            if (instruction.variable >= 0)
+                variables[instruction.variable] = instruction.value;
+            ++pc;
+            break;
+        case OP_NEXT: {
+            const Instruction& begin = instructions[loops.back().first];
+            if (++loops.back().second < begin.count) {
+                if (begin.variable >= 0)
+                    variables[begin.variable] = begin.value + loops.back().second * begin.step;
+                pc = loops.back().first + 1;
+            } else {
+                loops.pop_back();
+                ++pc;
+            }
+            break;
+        }
+        case OP_PARALLEL: {
+            // The devices of the instructions differ, so they can be
+            // applied one after the other. The block takes as long as
+            // the longest one.
+            double start = _time;
+            double duration = 0;
+            QStringList descriptions;
+            for (int i = pc + 1; i <= pc + instruction.count; ++i) {
+                const Instruction& subinstruction = instructions[i];
+                QString description;
+                double value = subinstruction.variable >= 0 ? variables[subinstruction.variable] : subinstruction.value;
+                duration = std::max(duration, _apply(subinstruction, value, &description));
+                descriptions.append(description);
+            }
+            _advance(duration);
+            _record(start, instruction.command, "In parallel: " + descriptions.join("; "));
+            pc += instruction.count + 1;
+            break;
+        }
+        case OP_WAIT:
+        case OP_VOLTAGESOURCEOUTPUT:
+        case OP_VOLTAGESOURCESET:
+        case OP_CHILLEROUTPUT:
+        case OP_CHILLERSET:
+        case OP_DAQCMD: {
+            double start = _time;
+            QString description;
+            double value = instruction.variable >= 0 ? variables[instruction.variable] : instruction.value;
+            _advance(_apply(instruction, value, &description));
+            _record(start, instruction.command, description);
+            ++pc;
+            break;
+        }
+        }
+    }
+
+    _result.duration = _time;
+    return _result;
+}
+
+double CommandSimulator::_apply(const Instruction& instruction, double value, QString* description) {
+    switch (instruction.op) {
+    case OP_WAIT:
+        *description = "Wait for " + QString::number(value) + " s";
+        return value;
+    case OP_VOLTAGESOURCEOUTPUT:
+    case OP_VOLTAGESOURCESET: {
+        PowerControlClass* source = _program.getSource(instruction.device);
+        SourceModel& model = _sources.at(source);
+        QString name = QString::fromStdString(_controller->getId(source));
+        double duration = 0;
+        // Output 0 means all outputs
+        int first = instruction.output == 0 ? 0 : instruction.output - 1;
+        int last = instruction.output == 0 ? model.outputs.size() - 1 : instruction.output - 1;
+        for (int i = first; i <= last; ++i) {
+            OutputState& output = model.outputs[i];
+            if (instruction.op == OP_VOLTAGESOURCESET) {
+                output.set = value;
+                if (output.on)
+                    duration = std::max(duration, _rampVoltage(model, output, value));
+            } else if (value != 0) {
+                output.on = true;
+                duration = std::max(duration, _rampVoltage(model, output, output.set));
+            } else {
+                // Ramps down in the background, the executer doesn't wait
+                output.on = false;
+                output.applied = 0;
+            }
+        }
+        if (instruction.op == OP_VOLTAGESOURCESET)
+            *description = "Set " + name + " to " + QString::number(value) + " V";
+        else
+            *description = "Turn " + name + (value != 0 ? " on" : " off");
+        return duration;
+    }
+    case OP_CHILLEROUTPUT:
+    case OP_CHILLERSET: {
+        Chiller* chiller = _program.getChiller(instruction.device);
+        ChillerModel& model = _chillers.at(chiller);
+        QString name = QString::fromStdString(_controller->getId(chiller));
+        if (instruction.op == OP_CHILLERSET) {
+            model.target = value;
+            *description = "Set " + name + " to " + QString::number(value) + " °C";
+        } else {
+            model.on = value != 0;
+            *description = "Turn " + name + (model.on ? " on" : " off");
+        }
+        if (not model.on)
+            return 0;
+        // Until the bath is at the working temperature
+        double difference = std::abs(model.target - model.bath) - CHILLER_TEMP_EPSILON;
+        if (difference <= 0)
+            return 0;
+        double rate = model.target > model.bath ? model.heatingRate : model.coolingRate;
+        if (rate == 0) {
+            // Rate of 0 for instantly
+            model.bath = model.target;
+            _result.minTemperature = std::min(_result.minTemperature, model.bath);
+            _result.maxTemperature = std::max(_result.maxTemperature, model.bath);
+            return 0;
+        }
+        return difference / rate;
+    }
+    case OP_DAQCMD:
+        ++_result.daqCommands;
+        *description = "DAQ command " + _program.getDaqExecName(instruction.device) + " (duration unknown)";
+        return 0;
+    case OP_PARALLEL:
+    case OP_LOOP:
+    case OP_NEXT:
+        break;
+    }
+    return 0;
+}
+
+double CommandSimulator::_rampVoltage(SourceModel& source, OutputState& output, double target) {
+    double duration = 0;
+    if (source.rampRate > 0)
+        duration = std::abs(target - output.applied) / source.rampRate;
+    output.applied = target;
+    if (source.highVoltage)
+        _result.peakHighVoltage = std::max(_result.peakHighVoltage, std::abs(target));
+    return duration;
+}
+
+void CommandSimulator::_advance(double seconds) {
+    _time += seconds;
+    for (auto& entry: _chillers) {
+        ChillerModel& model = entry.second;
+        if (not model.on or model.bath == model.target or seconds <= 0)
+            continue;
+        if (model.target > model.bath)
+            model.bath = std::min(model.target, model.bath + model.heatingRate * seconds);
+        else
+            model.bath = std::max(model.target, model.bath - model.coolingRate * seconds);
+        _result.minTemperature = std::min(_result.minTemperature, model.bath);
+        _result.maxTemperature = std::max(_result.maxTemperature, model.bath);
+    }
+}
+
+void CommandSimulator::_record(double start, int command, const QString& description) {
+    TimelineEntry entry;
+    entry.start = start;
+    entry.end = _time;
+    entry.command = command;
+    entry.description = description;
+    entry.highVoltage = _getHighVoltage();
+    entry.temperature = _chillers.empty() ? std::numeric_limits<double>::quiet_NaN() : _chillers.at(_controller->getChillers()[0]).bath;
+    _result.timeline.push_back(entry);
+}
+
+double CommandSimulator::_getHighVoltage() const {
+    double voltage = 0;
+    for (const auto& entry: _sources) {
+        if (not entry.second.highVoltage)
+            continue;
+        for (const auto& output: entry.second.outputs) {
+            if (output.on)
+                voltage = std::max(voltage, std::abs(output.applied));
+        }
+    }
+    return voltage;
+}
@@ -0,0 +1,91 @@
+#ifndef COMMANDSIMULATOR_H
+#define COMMANDSIMULATOR_H
+
+#include <QString>
+#include <map>
+#include <vector>
+#include "general/commandprogram.h"
+#include "general/systemcontrollerclass.h"
+
+// Step of a simulated run
+struct TimelineEntry {
+    double start; // s since the start of the run
+    double end;
+    int command; // Index of the command in the list
+    QString description;
+    double highVoltage; // Largest absolute voltage of the high voltage sources at the end, V
+    double temperature; // Bath temperature of the first chiller at the end, °C. NaN if there is none
+};
+
+struct SimulationResult {
+    std::vector<TimelineEntry> timeline;
+    double duration; // s
+    double peakHighVoltage; // Largest absolute voltage of the high voltage sources, V
+    double minTemperature; // Of the baths of all chillers, °C. NaN if there are no chillers
+    double maxTemperature;
+    int daqCommands; // Their run time isn't known and not included in duration
+};
+
+// Runs a compiled command list against models of the devices instead of
+// the devices, which don't need to be initialized. The run takes as long
+// as the computation, no matter how long the real run takes.
+//
+// Voltage sources ramp with rampRate (V/s) from the hardware description,
+// Keithleys by default with SWEEP_STEP every SWEEP_INTERVAL, others
+// instantly. Chillers heat and cool with heatingRate and coolingRate (K/min)
+// and start at startTemperature (°C).
+class CommandSimulator {
+public:
+    CommandSimulator(const CommandProgram& program, const SystemControllerClass* controller);
+
+    SimulationResult run();
+
+    const double DEFAULT_HEATING_RATE = 1; // K/min
+    const double DEFAULT_COOLING_RATE = 0.5; // K/min
+    const double DEFAULT_START_TEMPERATURE = 20; // °C
+    const double CHILLER_TEMP_EPSILON = 0.1; // °C, like the executer
+
+private:
+    struct OutputState {
+        double set;
+        double applied;
+        bool on;
+    };
+    struct SourceModel {
+        double rampRate; // V/s, 0 for instantly
+        bool highVoltage;
+        std::vector<OutputState> outputs;
+    };
+    struct ChillerModel {
+        double heatingRate; // K/s
+        double coolingRate; // K/s
+        double bath;
+        double target;
+        bool on;
+    };
+
+    const CommandProgram& _program;
+    const SystemControllerClass* _controller;
+    std::map<const PowerControlClass*, SourceModel> _sources;
+    std::map<const Chiller*, ChillerModel> _chillers;
+    SimulationResult _result;
+    double _time;
+
+    static double _getRate(const SystemControllerClass* controller, const GenericInstrumentClass* device, const std::string& name, double defaultValue);
+
+    /**
+     * Apply an instruction to the models without letting time pass
+     * @return Time the executer would wait for the instruction, s
+     */
+    double _apply(const Instruction& instruction, double value, QString* description);
+    double _rampVoltage(SourceModel& source, OutputState& output, double target);
+
+    /**
+     * Let time pass, the chillers keep moving towards their targets
+     */
+    void _advance(double seconds);
+    void _record(double start, int command, const QString& description);
+    double _getHighVoltage() const;
+};
+
+#endif // COMMANDSIMULATOR_H
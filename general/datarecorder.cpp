@@ -0,0 +1,189 @@
+#include "datarecorder.h"
+
+#include "general/BurnInException.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QTextStream>
+#include <QtGlobal>
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+const char RECORDER_MAGIC[8] = {'B', 'I', 'R', 'E', 'C', '0', '0', '1'};
+const int RECORDER_FLUSH_INTERVAL = 500; // ms
+const size_t RECORDER_BATCH_SIZE = 4096; // Samples taken from the hub at once
+
+static_assert(sizeof(DataRecorder::FileHeader) == 16, "FileHeader must not contain padding");
+static_assert(sizeof(DataRecorder::Record) == 24, "Record must not contain padding");
+
+DataRecorder::DataRecorder(SampleHub* hub, const std::string& directory, qint64 maxFileSize) {
+    _hub = hub;
+    _consumer = -1;
+    _directory = directory;
+    _maxFileSize = maxFileSize;
+    _fileIndex = 0;
+    _samples.resize(RECORDER_BATCH_SIZE);
+    _records.resize(RECORDER_BATCH_SIZE);
+
+    _timer = new QTimer(this);
+    moveToThread(&_thread);
+
+    connect(&_thread, &QThread::started, this, &DataRecorder::_begin);
+    connect(_timer, &QTimer::timeout, this, &DataRecorder::_flush);
+
+    // Runs on the recorder's thread right before it ends
+    connect(&_thread, &QThread::finished, this, [this]() {
+        _timer->stop();
+        _flush();
+        _file.close();
+    }, Qt::DirectConnection);
+}
+
+DataRecorder::~DataRecorder() {
+    stop();
+}
+
+void DataRecorder::start() {
+    Q_ASSERT(not _thread.isRunning());
+
+    QString name = QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss");
+    QDir dir(QString::fromStdString(_directory));
+    if (not dir.mkpath(name))
+        throw BurnInException("Could not create directory for recording in " + _directory);
+    _recording = dir.filePath(name).toStdString();
+
+    QFile channels(QString::fromStdString(_recording + "/channels.txt"));
+    if (not channels.open(QFile::WriteOnly | QFile::Text))
+        throw BurnInException("Could not write channel list of recording " + _recording);
+    QTextStream out(&channels);
+    std::vector<std::string> names = _hub->getChannelNames();
+    for (size_t i = 0; i < names.size(); ++i)
+        out << i << '\t' << QString::fromStdString(names[i]) << '\n';
+    channels.close();
+
+    if (_consumer < 0)
+        _consumer = _hub->addConsumer();
+    _fileIndex = 0;
+    qInfo("Recording readings to %s", _recording.c_str());
+    _thread.start();
+}
+
+void DataRecorder::stop() {
+    _thread.quit();
+    _thread.wait();
+}
+
+std::string DataRecorder::getDirectory() const {
+    return _directory;
+}
+
+void DataRecorder::_begin() {
+    _openDataFile();
+    _timer->start(RECORDER_FLUSH_INTERVAL);
+}
+
+void DataRecorder::_flush() {
+    size_t count;
+    bool written = false;
+    while ((count = _hub->drain(_consumer, _samples.data(), _samples.size())) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            _records[i].time = _samples[i].time;
+            _records[i].value = _samples[i].value;
+            _records[i].channel = _samples[i].channel;
+            _records[i].reserved = 0;
+        }
+
+        qint64 size = count * sizeof(Record);
+        if (not _file.isOpen()) {
+            _openDataFile();
+        } else if (_file.size() + size > _maxFileSize) {
+            ++_fileIndex;
+            _openDataFile();
+        }
+
+        if (_file.isOpen() and _file.write(reinterpret_cast<const char*>(_records.data()), size) != size)
+            qCritical("Could not write to %s: %s", _file.fileName().toLatin1().data(),
+                _file.errorString().toLatin1().data());
+        written = true;
+    }
+    if (written and _file.isOpen())
+        _file.flush();
+}
+
+void DataRecorder::_openDataFile() {
+    _file.close();
+
+    char name[32];
+    snprintf(name, sizeof(name), "/data-%04d.bin", _fileIndex);
+    _file.setFileName(QString::fromStdString(_recording + name));
+    if (not _file.open(QFile::WriteOnly)) {
+        qCritical("Could not open %s for recording: %s", _file.fileName().toLatin1().data(),
+            _file.errorString().toLatin1().data());
+        return;
+    }
+
+    FileHeader header;
+    memcpy(header.magic, RECORDER_MAGIC, sizeof(header.magic));
+    header.recordSize = sizeof(Record);
+    header.reserved = 0;
+    _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void DataRecorder::exportCsv(const std::string& recording, const std::string& csvFile) {
+    QDir dir(QString::fromStdString(recording));
+
+    std::map<quint32, QByteArray> channels;
+    QFile channelsFile(dir.filePath("channels.txt"));
+    if (not channelsFile.open(QFile::ReadOnly | QFile::Text))
+        throw BurnInException("Could not read channel list of recording " + recording);
+    while (not channelsFile.atEnd()) {
+        QByteArray line = channelsFile.readLine().trimmed();
+        int tab = line.indexOf('\t');
+        if (tab < 1)
+            continue;
+        channels[line.left(tab).toUInt()] = line.mid(tab + 1);
+    }
+
+    QFile out(QString::fromStdString(csvFile));
+    if (not out.open(QFile::WriteOnly | QFile::Text))
+        throw BurnInException("Could not open " + csvFile + " for writing");
+    out.write("time,channel,value\n");
+
+    QStringList dataFiles = dir.entryList({"data-*.bin"}, QDir::Files, QDir::Name);
+    for (const QString& name: dataFiles) {
+        QFile file(dir.filePath(name));
+        if (not file.open(QFile::ReadOnly) or file.size() < static_cast<qint64>(sizeof(FileHeader))) {
+            qWarning("Skipping unreadable data file %s", name.toLatin1().data());
+            continue;
+        }
+
+        uchar* data = file.map(0, file.size());
+        if (data == nullptr) {
+            qWarning("Could not map data file %s", name.toLatin1().data());
+            continue;
+        }
+        const FileHeader* header = reinterpret_cast<const FileHeader*>(data);
+        if (memcmp(header->magic, RECORDER_MAGIC, sizeof(header->magic)) != 0
+                or header->recordSize != sizeof(Record)) {
+            qWarning("%s is no recorder data file", name.toLatin1().data());
+            continue;
+        }
+
+        // A partially written record at the end is ignored
+        size_t count = (file.size() - sizeof(FileHeader)) / sizeof(Record);
+        const Record* records = reinterpret_cast<const Record*>(data + sizeof(FileHeader));
+        char line[64];
+        for (size_t i = 0; i < count; ++i) {
+            snprintf(line, sizeof(line), "%lld,", static_cast<long long>(records[i].time));
+            out.write(line);
+            if (channels.count(records[i].channel) > 0)
+                out.write(channels.at(records[i].channel));
+            else
+                out.write(QByteArray::number(records[i].channel));
+            // Independent of the locale, unlike printf
+            out.write("," + QByteArray::number(records[i].value, 'g', 10) + "\n");
+        }
+    }
+}
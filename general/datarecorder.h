@@ -0,0 +1,104 @@
+#ifndef DATARECORDER_H
+#define DATARECORDER_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QFile>
+
+#include <string>
+#include <vector>
+
+#include "general/samplehub.h"
+
+/**
+ * Records the readings published to a SampleHub to disk.
+ *
+ * Every call of start creates a new directory inside the recorder's
+ * directory, named after the time of the start. It contains the file
+ * channels.txt, with the id and the name of each channel separated by
+ * a tab per line, and the data files data-0000.bin, data-0001.bin, ...
+ * A new data file is begun when the current one reached its maximum
+ * size.
+ *
+ * A data file starts with a FileHeader followed by Records. Both have
+ * a fixed size and are stored in the byte order of the machine, so a
+ * data file can be memory-mapped and used as an array of Records.
+ *
+ * The recorder's thread takes the samples from the hub in batches and
+ * writes them twice per second.
+ */
+class DataRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct FileHeader {
+        char magic[8]; // "BIREC001"
+        quint32 recordSize; // sizeof(Record)
+        quint32 reserved;
+    };
+
+    struct Record {
+        qint64 time; // ns since the epoch, UTC
+        double value;
+        quint32 channel;
+        quint32 reserved;
+    };
+
+    /**
+     * @param hub Hub to take the samples from. Must outlive the recorder
+     * @param directory Directory to create the recordings in
+     * @param maxFileSize Size in bytes after which a new data file is begun
+     */
+    DataRecorder(SampleHub* hub, const std::string& directory, qint64 maxFileSize = 256 * 1024 * 1024);
+    virtual ~DataRecorder();
+
+    DataRecorder(const DataRecorder& other) = delete;
+    DataRecorder& operator=(const DataRecorder& other) = delete;
+
+    /**
+     * Create the directory of the recording, write the channel
+     * dictionary of the hub and start writing in a separate thread.
+     * Samples published before aren't recorded.
+     */
+    void start();
+
+    /**
+     * Write all samples recorded so far and stop
+     */
+    void stop();
+
+    std::string getDirectory() const;
+
+    /**
+     * Convert a recording to a CSV file with the columns time (in ns
+     * since the epoch), channel and value.
+     * @param recording Directory of one recording, as created by start
+     * @param csvFile Path of the CSV file to write
+     */
+    static void exportCsv(const std::string& recording, const std::string& csvFile);
+
+private slots:
+    void _begin();
+    void _flush();
+
+private:
+    void _openDataFile();
+
+    SampleHub* _hub;
+    int _consumer;
+    std::string _directory;
+    std::string _recording;
+    qint64 _maxFileSize;
+
+    std::vector<Sample> _samples;
+    std::vector<Record> _records;
+
+    QFile _file;
+    int _fileIndex;
+    QTimer* _timer;
+    QThread _thread;
+};
+
+#endif // DATARECORDER_H
@@ -0,0 +1,67 @@
+#include "devicepoller.h"
+
+#include "general/BurnInException.h"
+
+#include <exception>
+
+DevicePoller::DevicePoller(const std::string& name, std::function<void()> poll, DeviceContext* context) {
+    _name = name;
+    _poll = poll;
+    _busy = false;
+    _skipped = 0;
+    _requested = 0;
+    _clock.start();
+    _context = context;
+}
+
+DevicePoller::~DevicePoller() {
+    // A poll still queued refers to the poller
+    _context->call([]() {});
+}
+
+bool DevicePoller::trigger() {
+    if (_busy.exchange(true)) {
+        ++_skipped;
+        qDebug("Device %s is still busy. Skipping refresh", _name.c_str());
+        return false;
+    }
+
+    _requested = _clock.nsecsElapsed();
+    _context->post([this]() {
+        _doPoll();
+    });
+    return true;
+}
+
+bool DevicePoller::isBusy() const {
+    return _busy;
+}
+
+unsigned long DevicePoller::getSkippedCount() const {
+    return _skipped;
+}
+
+std::string DevicePoller::getName() const {
+    return _name;
+}
+
+QThread* DevicePoller::getThread() {
+    return _context->getThread();
+}
+
+void DevicePoller::_doPoll() {
+    qint64 started = _clock.nsecsElapsed();
+    try {
+        _poll();
+    } catch (const BurnInException& e) {
+        qCritical("Error while refreshing %s: %s", _name.c_str(), e.what());
+    } catch (const std::exception& e) {
+        // E.g. parsing an empty answer. The next poll has to run anyway
+        qCritical("Unexpected error while refreshing %s: %s", _name.c_str(), e.what());
+    } catch (...) {
+        qCritical("Unknown error while refreshing %s", _name.c_str());
+    }
+    qint64 finished = _clock.nsecsElapsed();
+    _busy = false;
+    emit pollFinished((started - _requested) / 1000, (finished - started) / 1000);
+}
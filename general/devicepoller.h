@@ -0,0 +1,84 @@
+#ifndef DEVICEPOLLER_H
+#define DEVICEPOLLER_H
+
+#include <QObject>
+#include <QThread>
+#include <QElapsedTimer>
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+#include "devices/devicecontext.h"
+
+/**
+ * Runs the function refreshing the readings of one device on the
+ * context of the device, so that a slow device can not delay the
+ * readings of the other devices. Polls are queued with the other
+ * operations of the device.
+ */
+class DevicePoller : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param name Name of the polled device, used for log messages
+     * @param poll Function querying the device. Gets called on the
+     *     thread of the context
+     * @param context Context of the device. Must outlive the poller
+     */
+    DevicePoller(const std::string& name, std::function<void()> poll, DeviceContext* context);
+    virtual ~DevicePoller();
+
+    DevicePoller(const DevicePoller& other) = delete;
+    DevicePoller& operator=(const DevicePoller& other) = delete;
+
+    /**
+     * Request a poll of the device. Returns immediately. If the device
+     * is still busy with the previous poll, the request gets skipped
+     * instead of being queued.
+     * @return true if the poll was scheduled, false if it was skipped
+     */
+    bool trigger();
+
+    /**
+     * @return Whether a poll is currently running or scheduled
+     */
+    bool isBusy() const;
+
+    /**
+     * @return Number of requests skipped because the device was busy
+     */
+    unsigned long getSkippedCount() const;
+
+    std::string getName() const;
+
+    /**
+     * @return The thread the device is polled on
+     */
+    QThread* getThread();
+
+signals:
+    /**
+     * Emitted on the thread of the context after every poll
+     * @param waited Time in µs from the request until the poll started
+     * @param duration Time in µs the poll took
+     */
+    void pollFinished(qint64 waited, qint64 duration);
+
+private:
+    void _doPoll();
+
+    std::string _name;
+    std::function<void()> _poll;
+
+    std::atomic<bool> _busy;
+    std::atomic<unsigned long> _skipped;
+    std::atomic<qint64> _requested; // ns on _clock of the last request
+    QElapsedTimer _clock;
+
+    DeviceContext* _context;
+};
+
+#endif // DEVICEPOLLER_H
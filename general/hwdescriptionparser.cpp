@@ -50,8 +50,10 @@ std::vector<InstrumentDescription> HWDescriptionParser::ParseXML(QString pFileNa
                 cInstruments.push_back(ParseRaspberry(cXmlFile));
             else if (namelower == "daqmodule")
                 cInstruments.push_back(ParseDAQModule(cXmlFile));
+            else if (namelower == "recorder")
+                cInstruments.push_back(ParseRecorder(cXmlFile));
             else
-                throw BurnInException("Invalid tag \"" + name + "\". Valid tags are: LowVoltageSource, HighVoltageSource, Chiller, Peltier, Thermorasp, DAQModule");
+                throw BurnInException("Invalid tag \"" + name + "\". Valid tags are: LowVoltageSource, HighVoltageSource, Chiller, Peltier, Thermorasp, DAQModule, Recorder");
         }
     }
     if (cXmlFile->hasError())
@@ -74,6 +76,13 @@ InstrumentDescription HWDescriptionParser::ParseGeneric(const QXmlStreamReader *
     if (cInstrument.attrs.count("class") == 0)
         throw BurnInException("Device is missing class attribute: " + pXmlFile->name().toString().toStdString());
     
+    if (cInstrument.attrs.count("pollinterval") > 0) {
+        bool ok;
+        cInstrument.pollInterval = QString::fromStdString(cInstrument.attrs.at("pollinterval")).toUInt(&ok);
+        if (not ok or cInstrument.pollInterval == 0)
+            throw BurnInException("Invalid pollInterval \"" + cInstrument.attrs.at("pollinterval") + "\". Needs to be a positive number of milliseconds");
+    }
+    
     return cInstrument;
 }
 
@@ -84,7 +93,9 @@ InstrumentDescription HWDescriptionParser::ParseVoltageSource(QXmlStreamReader *
         cInstrument.type = "LowVoltageSource";
     else
         cInstrument.type = "HighVoltageSource";
-    if (cInstrument.attrs.count("address") == 0)
+    // Simulated devices don't need an address
+    bool simulated = cInstrument.attrs.count("simulate") != 0 and cInstrument.attrs.at("simulate") == "true";
+    if (cInstrument.attrs.count("address") == 0 and not simulated)
         throw BurnInException("Device is missing address attribute: " + pXmlFile->name().toString().toStdString());
 
     while (pXmlFile->readNextStartElement()) {
@@ -163,3 +174,18 @@ InstrumentDescription HWDescriptionParser::ParseDAQModule(QXmlStreamReader *pXml
         throw BurnInException("DAQModule is missing attributes. Need fc7port, controlhubpath, ph2acfpath, daqhwdescfile, daqimage");
     return cInstrument;
 }
+
+InstrumentDescription HWDescriptionParser::ParseRecorder(QXmlStreamReader *pXmlFile) {
+    // Not a device, so there is no class attribute
+    InstrumentDescription cInstrument;
+    cInstrument.type = "Recorder";
+    for (const auto& attribute: pXmlFile->attributes()) {
+        std::string name = attribute.name().toString().toLower().toStdString();
+        std::string value = attribute.value().toString().toStdString();
+        cInstrument.attrs[name] = value;
+    }
+    pXmlFile->skipCurrentElement();
+    if (cInstrument.attrs.count("directory") == 0)
+        throw BurnInException("Recorder is missing attribute directory");
+    return cInstrument;
+}
@@ -9,6 +9,7 @@ struct InstrumentDescription {
   std::string type;
   std::map<std::string, std::string> attrs;
   std::vector<std::map<std::string, std::string>> settings;
+  unsigned int pollInterval = 0; // ms between two refreshes, 0 for default
 };
 
 class HWDescriptionParser
@@ -26,6 +27,8 @@ private:
     InstrumentDescription ParseRaspberry(QXmlStreamReader *pXmlFile);
     
     InstrumentDescription ParseDAQModule(QXmlStreamReader *pXmlFile);
+    
+    InstrumentDescription ParseRecorder(QXmlStreamReader *pXmlFile);
 };
 
 #endif // HWDESCRIPTIONPARSER_H
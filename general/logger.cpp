@@ -1,5 +1,8 @@
 #include "logger.h"
 
+#include <QDateTime>
+#include <QMutexLocker>
+
 Logger::Logger(bool enableTermOutput, bool enableColorForTerm) {
     _enableTermOutput = enableTermOutput;
     _enableColorForTerm = enableColorForTerm;
@@ -17,6 +20,7 @@ void Logger::handleMessage(QtMsgType type, const QMessageLogContext& /* context
         else
             _printNoColorTerm(type, msg_);
     }
+    _printFile(type, msg_);
     
     switch (type) {
     case QtDebugMsg:
@@ -38,6 +42,44 @@ void Logger::handleMessage(QtMsgType type, const QMessageLogContext& /* context
     emit newMessage(type, msg_);
 }
 
+bool Logger::setLogFile(const QString& path) {
+    QMutexLocker locker(&_logFileMutex);
+    _logFile.close();
+    _logFile.setFileName(path);
+    return _logFile.open(QFile::WriteOnly | QFile::Append | QFile::Text);
+}
+
+void Logger::_printFile(QtMsgType type, const QString& msg) {
+    if (not _logFile.isOpen())
+        return;
+    
+    QString prefix;
+    switch (type) {
+    case QtDebugMsg:
+        prefix = "Debug: ";
+        break;
+    case QtInfoMsg:
+        prefix = "Info: ";
+        break;
+    case QtWarningMsg:
+        prefix = "Warning: ";
+        break;
+    case QtCriticalMsg:
+        prefix = "Critical: ";
+        break;
+    case QtFatalMsg:
+        prefix = "Fatal: ";
+        break;
+    }
+    QString line = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz ") + prefix + msg + "\n";
+    
+    QMutexLocker locker(&_logFileMutex);
+    if (not _logFile.isOpen())
+        return;
+    _logFile.write(line.toLocal8Bit());
+    _logFile.flush();
+}
+
 void Logger::_printNoColorTerm(QtMsgType type, const QString& msg) {
     QByteArray localMsg = msg.toLocal8Bit();
     switch (type) {
@@ -2,6 +2,8 @@
 #define LOGGER_H
 
 #include <QObject>
+#include <QFile>
+#include <QMutex>
 
 class Logger : public QObject
 {
@@ -10,6 +12,13 @@ public:
     Logger(bool enableTermOutput, bool enableColorForTerm);
     
     void handleMessage(QtMsgType type, const QMessageLogContext &context, const QString &msg);
+    
+    /**
+     * Additionally append all messages with a time stamp to a file
+     * @param path Path of the file
+     * @return false if the file couldn't be opened
+     */
+    bool setLogFile(const QString& path);
 
 signals:
     void newMessage(QtMsgType type, const QString& msg);
@@ -24,7 +33,10 @@ public slots:
 private:
     bool _enableTermOutput;
     bool _enableColorForTerm;
+    QFile _logFile;
+    QMutex _logFileMutex;
     
+    void _printFile(QtMsgType type, const QString& msg);
     void _printNoColorTerm(QtMsgType type, const QString& msg);
     void _printColorTerm(QtMsgType type, const QString& msg);
 };
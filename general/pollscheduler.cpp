@@ -0,0 +1,83 @@
+#include "pollscheduler.h"
+
+#include <QtGlobal>
+
+PollScheduler::PollScheduler() {
+    _timer = new QTimer(this);
+    _timer->setSingleShot(true);
+    moveToThread(&_thread);
+    
+    connect(&_thread, &QThread::started, this, &PollScheduler::_begin);
+    connect(_timer, &QTimer::timeout, this, &PollScheduler::_onTimeout);
+    // finished is emitted on the scheduler thread, which owns the timer.
+    // Stopping it there keeps it from being killed from another thread
+    // once the scheduler is stopped or destroyed.
+    connect(&_thread, &QThread::finished, _timer, &QTimer::stop, Qt::DirectConnection);
+}
+
+PollScheduler::~PollScheduler() {
+    stop();
+    
+    // Waits for running polls to finish
+    for (const auto& entry: _entries)
+        delete entry.poller;
+}
+
+void PollScheduler::addPoller(DevicePoller* poller, unsigned int interval) {
+    Q_ASSERT(not _thread.isRunning());
+    Q_ASSERT(interval > 0);
+    _entries.push_back({0, interval, poller});
+}
+
+void PollScheduler::start() {
+    Q_ASSERT(not _thread.isRunning());
+    _thread.start();
+}
+
+void PollScheduler::stop() {
+    _thread.quit();
+    _thread.wait();
+}
+
+std::vector<DevicePoller*> PollScheduler::getPollers() const {
+    std::vector<DevicePoller*> pollers;
+    for (const auto& entry: _entries)
+        pollers.push_back(entry.poller);
+    return pollers;
+}
+
+void PollScheduler::_begin() {
+    _queue = decltype(_queue)();
+    _clock.start();
+    for (Entry entry: _entries) {
+        entry.deadline = entry.interval;
+        _queue.push(entry);
+    }
+    _arm();
+}
+
+void PollScheduler::_onTimeout() {
+    qint64 now = _clock.elapsed();
+    while (not _queue.empty() and _queue.top().deadline <= now) {
+        Entry entry = _queue.top();
+        _queue.pop();
+        
+        bool skipped = not entry.poller->trigger();
+        emit pollerTriggered(entry.poller, _clock.nsecsElapsed() / 1000 - entry.deadline * 1000, skipped);
+        
+        // Deadlines that already passed are dropped instead of being
+        // caught up on
+        entry.deadline += entry.interval;
+        if (entry.deadline <= now)
+            entry.deadline += ((now - entry.deadline) / entry.interval + 1) * entry.interval;
+        _queue.push(entry);
+    }
+    _arm();
+}
+
+void PollScheduler::_arm() {
+    if (_queue.empty())
+        return;
+    qint64 wait = _queue.top().deadline - _clock.elapsed();
+    _timer->start(wait > 0 ? static_cast<int>(wait) : 0);
+}
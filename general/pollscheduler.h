@@ -0,0 +1,88 @@
+#ifndef POLLSCHEDULER_H
+#define POLLSCHEDULER_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include <queue>
+#include <vector>
+
+#include "general/devicepoller.h"
+
+/**
+ * Triggers device pollers, each one at its own interval. The scheduler
+ * keeps the pollers ordered by their next deadline and sleeps until
+ * the earliest one. On equal deadlines, pollers with a shorter interval
+ * are triggered first.
+ */
+class PollScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    PollScheduler();
+    virtual ~PollScheduler();
+
+    PollScheduler(const PollScheduler& other) = delete;
+    PollScheduler& operator=(const PollScheduler& other) = delete;
+
+    /**
+     * Add a poller. Must be called before start.
+     * @param poller The poller. The scheduler takes ownership
+     * @param interval Time between two polls in ms
+     */
+    void addPoller(DevicePoller* poller, unsigned int interval);
+
+    /**
+     * Start triggering the pollers in a separate thread
+     */
+    void start();
+
+    /**
+     * Stop triggering the pollers. Polls already running are not
+     * interrupted.
+     */
+    void stop();
+
+    std::vector<DevicePoller*> getPollers() const;
+
+signals:
+    /**
+     * Emitted on the thread of the scheduler whenever a poller is due
+     * @param poller The poller
+     * @param lateness Time in µs the trigger came after the deadline
+     * @param skipped Whether the poll was skipped because the previous
+     *     one was still running
+     */
+    void pollerTriggered(DevicePoller* poller, qint64 lateness, bool skipped);
+
+private slots:
+    void _begin();
+    void _onTimeout();
+
+private:
+    struct Entry {
+        qint64 deadline; // ms since start
+        unsigned int interval; // ms
+        DevicePoller* poller;
+    };
+    struct EntryLater {
+        bool operator()(const Entry& a, const Entry& b) const {
+            if (a.deadline != b.deadline)
+                return a.deadline > b.deadline;
+            return a.interval > b.interval;
+        }
+    };
+
+    void _arm();
+
+    std::vector<Entry> _entries;
+    std::priority_queue<Entry, std::vector<Entry>, EntryLater> _queue;
+    QElapsedTimer _clock;
+    QTimer* _timer;
+    QThread _thread;
+};
+
+#endif // POLLSCHEDULER_H
@@ -0,0 +1,96 @@
+#include "samplehub.h"
+#include "general/statetable.h"
+
+#include <QMutexLocker>
+
+#include <chrono>
+
+SampleHub::SampleHub(size_t capacity) {
+    _capacity = capacity;
+    _numConsumers = 0;
+    _stateTable = nullptr;
+    _shared = _newProducer(nullptr);
+}
+
+SampleHub::~SampleHub() {
+    for (Producer* producer: _producers) {
+        for (int i = 0; i < MAX_CONSUMERS; ++i)
+            delete producer->queues[i];
+        delete producer;
+    }
+}
+
+quint32 SampleHub::addChannel(const std::string& name) {
+    _channels.push_back(name);
+    return static_cast<quint32>(_channels.size() - 1);
+}
+
+std::vector<std::string> SampleHub::getChannelNames() const {
+    return _channels;
+}
+
+void SampleHub::addProducer(QThread* thread) {
+    _newProducer(thread);
+}
+
+void SampleHub::setStateTable(StateTable* table) {
+    _stateTable = table;
+}
+
+int SampleHub::addConsumer() {
+    Q_ASSERT(_numConsumers < MAX_CONSUMERS);
+    return _numConsumers++;
+}
+
+void SampleHub::publish(quint32 channel, double value, bool changed) {
+    Sample sample;
+    sample.time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    sample.value = value;
+    sample.channel = channel;
+    sample.changed = changed;
+    int consumers = _numConsumers;
+    if (_stateTable != nullptr)
+        _stateTable->stage(channel, value, sample.time);
+
+    QThread* current = QThread::currentThread();
+    for (Producer* producer: _producers) {
+        if (producer->thread == current) {
+            for (int i = 0; i < consumers; ++i)
+                producer->queues[i]->push(sample);
+            return;
+        }
+    }
+
+    QMutexLocker locker(&_sharedMutex);
+    for (int i = 0; i < consumers; ++i)
+        _shared->queues[i]->push(sample);
+}
+
+size_t SampleHub::drain(int consumer, Sample* out, size_t max) {
+    Q_ASSERT(consumer >= 0 and consumer < _numConsumers);
+    size_t count = 0;
+    for (Producer* producer: _producers)
+        count += producer->queues[consumer]->pop(out + count, max - count);
+    return count;
+}
+
+unsigned long SampleHub::getDroppedCount() const {
+    unsigned long dropped = 0;
+    for (const Producer* producer: _producers) {
+        for (int i = 0; i < MAX_CONSUMERS; ++i)
+            dropped += producer->queues[i]->getDroppedCount();
+    }
+    return dropped;
+}
+
+SampleHub::Producer* SampleHub::_newProducer(QThread* thread) {
+    // Queues for all possible consumers are created right away, so that
+    // adding a consumer later doesn't change what producers access
+    Producer* producer = new Producer;
+    producer->thread = thread;
+    for (int i = 0; i < MAX_CONSUMERS; ++i)
+        producer->queues[i] = new SampleQueue(_capacity);
+    _producers.push_back(producer);
+    return producer;
+}
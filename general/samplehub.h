@@ -0,0 +1,110 @@
+#ifndef SAMPLEHUB_H
+#define SAMPLEHUB_H
+
+#include <QObject>
+#include <QMutex>
+#include <QThread>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "general/samplequeue.h"
+
+class StateTable;
+
+/**
+ * Passes readings from the threads reading the devices to consumers
+ * like the recorder or the GUI.
+ *
+ * Every producer thread has one SampleQueue per consumer, so readings
+ * travel without locks, event loop or allocations. Readings published
+ * from threads that aren't registered as producers, e.g. set values
+ * changed from the GUI, go through queues shared by those threads,
+ * which are protected by a mutex on the producer side.
+ *
+ * Channels and producers have to be added before the first sample is
+ * published. Consumers can be added at any time, up to MAX_CONSUMERS.
+ */
+class SampleHub : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_CONSUMERS = 4;
+
+    /**
+     * @param capacity Number of samples each queue can hold
+     */
+    explicit SampleHub(size_t capacity = 4096);
+    virtual ~SampleHub();
+
+    SampleHub(const SampleHub& other) = delete;
+    SampleHub& operator=(const SampleHub& other) = delete;
+
+    /**
+     * @param name Name of the channel, e.g. TTi1/1/voltage
+     * @return Id of the channel, used for publish
+     */
+    quint32 addChannel(const std::string& name);
+    std::vector<std::string> getChannelNames() const;
+
+    /**
+     * Register a thread that publishes samples
+     */
+    void addProducer(QThread* thread);
+
+    /**
+     * Register a consumer. It gets every sample published from now on.
+     * @return Id of the consumer, used for drain
+     */
+    int addConsumer();
+
+    /**
+     * Publish a reading with the current time. Can be called from any
+     * thread. The reading is also staged in the state table, if set.
+     * @param changed false if the change filter of the device held the
+     *     reading back. It is still recorded, but not shown
+     */
+    void publish(quint32 channel, double value, bool changed = true);
+
+    /**
+     * Set the table keeping the latest value of every channel. Must be
+     * called before the first sample is published
+     * @param table The table, nullptr for none. Must outlive the hub
+     */
+    void setStateTable(StateTable* table);
+
+    /**
+     * Take the samples waiting for a consumer. Must always be called
+     * from the same thread for a consumer.
+     * @param consumer Id of the consumer as returned by addConsumer
+     * @param out Array to write the samples to
+     * @param max Maximum number of samples to take
+     * @return Number of samples taken
+     */
+    size_t drain(int consumer, Sample* out, size_t max);
+
+    /**
+     * @return Number of samples dropped because a queue was full
+     */
+    unsigned long getDroppedCount() const;
+
+private:
+    struct Producer {
+        QThread* thread; // nullptr for the queues shared by other threads
+        SampleQueue* queues[MAX_CONSUMERS];
+    };
+
+    Producer* _newProducer(QThread* thread);
+
+    size_t _capacity;
+    std::vector<std::string> _channels;
+    std::vector<Producer*> _producers;
+    Producer* _shared;
+    QMutex _sharedMutex;
+    std::atomic<int> _numConsumers;
+    StateTable* _stateTable;
+};
+
+#endif // SAMPLEHUB_H
@@ -0,0 +1,94 @@
+#ifndef SAMPLEQUEUE_H
+#define SAMPLEQUEUE_H
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * A single reading of a channel
+ */
+struct Sample {
+    qint64 time; // ns since the epoch, UTC
+    double value;
+    quint32 channel;
+    bool changed; // false if the change filter of the device held it back
+};
+
+/**
+ * Ring buffer passing samples from one producer thread to one consumer
+ * thread without locking. push may only be called by the producer and
+ * pop only by the consumer. If the buffer is full, new samples are
+ * dropped.
+ */
+class SampleQueue
+{
+public:
+    /**
+     * @param capacity Maximum number of samples held. Gets rounded up
+     *     to a power of two
+     */
+    explicit SampleQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity)
+            size *= 2;
+        _buffer.resize(size);
+        _mask = size - 1;
+        _head = 0;
+        _tail = 0;
+        _dropped = 0;
+    }
+
+    SampleQueue(const SampleQueue& other) = delete;
+    SampleQueue& operator=(const SampleQueue& other) = delete;
+
+    /**
+     * Add a sample. Producer only.
+     * @return false if the buffer was full and the sample was dropped
+     */
+    bool push(const Sample& sample) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) > _mask) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _buffer[tail & _mask] = sample;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Take samples out of the buffer, oldest first. Consumer only.
+     * @param out Array to write the samples to
+     * @param max Maximum number of samples to take
+     * @return Number of samples taken
+     */
+    size_t pop(Sample* out, size_t max) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t available = _tail.load(std::memory_order_acquire) - head;
+        size_t count = available < max ? available : max;
+        for (size_t i = 0; i < count; ++i)
+            out[i] = _buffer[(head + i) & _mask];
+        _head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @return Number of samples dropped because the buffer was full
+     */
+    unsigned long getDroppedCount() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<Sample> _buffer;
+    size_t _mask;
+    // Both only increase. Their difference is the number of samples held
+    std::atomic<size_t> _head; // Written by the consumer
+    std::atomic<size_t> _tail; // Written by the producer
+    std::atomic<unsigned long> _dropped;
+};
+
+#endif // SAMPLEQUEUE_H
@@ -0,0 +1,101 @@
+#include "statetable.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include <chrono>
+
+StateTable::StateTable(size_t numChannels) :
+    _published(new Slot[numChannels]),
+    _staged(new Slot[numChannels])
+{
+    _size = numChannels;
+    for (size_t i = 0; i < _size; ++i) {
+        _published[i].value.store(0, std::memory_order_relaxed);
+        _published[i].time.store(0, std::memory_order_relaxed);
+        _staged[i].value.store(0, std::memory_order_relaxed);
+        _staged[i].time.store(0, std::memory_order_relaxed);
+    }
+    _sequence = 0;
+    _publishTime = 0;
+}
+
+void StateTable::stage(quint32 channel, double value, qint64 time) {
+    Q_ASSERT(channel < _size);
+    // Every channel is only written by the thread of its device, which
+    // also publishes it, so no lock is needed
+    _staged[channel].value.store(value, std::memory_order_relaxed);
+    _staged[channel].time.store(time, std::memory_order_relaxed);
+}
+
+quint64 StateTable::publish(const std::vector<quint32>& channels) {
+    QMutexLocker locker(&_writeMutex);
+    quint64 sequence = _sequence.load(std::memory_order_relaxed);
+    _sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (quint32 channel: channels)
+        _write(channel);
+    _publishTime.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+
+    _sequence.store(sequence + 2, std::memory_order_release);
+    return sequence / 2 + 1;
+}
+
+quint64 StateTable::publishAll() {
+    std::vector<quint32> channels;
+    for (size_t i = 0; i < _size; ++i)
+        channels.push_back(static_cast<quint32>(i));
+    return publish(channels);
+}
+
+void StateTable::_write(quint32 channel) {
+    Q_ASSERT(channel < _size);
+    _published[channel].value.store(_staged[channel].value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    _published[channel].time.store(_staged[channel].time.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+StateSnapshot StateTable::snapshot() const {
+    StateSnapshot snapshot;
+    snapshot.channels.resize(_size);
+    while (true) {
+        quint64 before = _sequence.load(std::memory_order_acquire);
+        if (before % 2 == 1) {
+            // A publish only takes a few µs
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        for (size_t i = 0; i < _size; ++i) {
+            snapshot.channels[i].value = _published[i].value.load(std::memory_order_relaxed);
+            snapshot.channels[i].time = _published[i].time.load(std::memory_order_relaxed);
+        }
+        snapshot.time = _publishTime.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) == before) {
+            snapshot.sequence = before / 2;
+            return snapshot;
+        }
+    }
+}
+
+ChannelState StateTable::get(quint32 channel) const {
+    Q_ASSERT(channel < _size);
+    ChannelState state;
+    while (true) {
+        quint64 before = _sequence.load(std::memory_order_acquire);
+        if (before % 2 == 1) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        state.value = _published[channel].value.load(std::memory_order_relaxed);
+        state.time = _published[channel].time.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) == before)
+            return state;
+    }
+}
+
+size_t StateTable::getChannelCount() const {
+    return _size;
+}
@@ -0,0 +1,91 @@
+#ifndef STATETABLE_H
+#define STATETABLE_H
+
+#include <QMutex>
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Latest value of a channel
+struct ChannelState {
+    double value;
+    qint64 time; // ns since the epoch when it was read, 0 if there was none yet
+};
+
+// All channels as published at one point in time. The channels of one
+// device are from the same poll, different devices are polled at their
+// own intervals and can be from different times.
+struct StateSnapshot {
+    quint64 sequence; // Number of publishes before the snapshot
+    qint64 time; // ns since the epoch of the last publish
+    std::vector<ChannelState> channels; // Indexed by the channel ids of the hub
+};
+
+/**
+ * Latest value of every channel of the sample hub. Readings are staged
+ * as they arrive and become visible when the channels of a device are
+ * published after it was polled, so a device never shows up half
+ * refreshed. There is no common refresh cycle of all devices, so a
+ * snapshot is only consistent per device: every device appears as of
+ * its latest poll.
+ *
+ * Readers take a copy of all channels without locking. Publishing
+ * increments a sequence number before and after writing (seqlock); a
+ * reader retries if the number was odd or changed while it copied.
+ * Publishes are serialized by a mutex, which neither readers nor
+ * staging touch.
+ */
+class StateTable
+{
+public:
+    explicit StateTable(size_t numChannels);
+
+    StateTable(const StateTable& other) = delete;
+    StateTable& operator=(const StateTable& other) = delete;
+
+    /**
+     * Stage a reading. Doesn't lock. A channel may only be staged from
+     * one thread at a time, the one that publishes it
+     * @param time ns since the epoch
+     */
+    void stage(quint32 channel, double value, qint64 time);
+
+    /**
+     * Make the staged readings of channels visible to readers
+     * @return Number of publishes so far, as in StateSnapshot::sequence
+     */
+    quint64 publish(const std::vector<quint32>& channels);
+    quint64 publishAll();
+
+    /**
+     * @return Consistent copy of all channels. Never blocks
+     */
+    StateSnapshot snapshot() const;
+
+    /**
+     * @return Latest published value of one channel. Never blocks
+     */
+    ChannelState get(quint32 channel) const;
+
+    size_t getChannelCount() const;
+
+private:
+    struct Slot {
+        std::atomic<double> value;
+        std::atomic<qint64> time;
+    };
+
+    void _write(quint32 channel);
+
+    size_t _size;
+    std::unique_ptr<Slot[]> _published;
+    std::atomic<quint64> _sequence; // Odd while a publish is running
+    std::atomic<qint64> _publishTime;
+
+    std::unique_ptr<Slot[]> _staged; // Written by the thread of the device
+    QMutex _writeMutex; // Serializes publishes
+};
+
+#endif // STATETABLE_H
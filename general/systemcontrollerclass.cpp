@@ -1,35 +1,137 @@
+#include <algorithm>
+#include <functional>
 #include <string>
 #include <vector>
 #include <regex>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <memory>
 
 #include <QCoreApplication>
-#include <QFileDialog>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QRegularExpression>
+#include <QStringList>
 #include <QTextStream>
 #include <QString>
 #include <QTime>
 
 #include "general/systemcontrollerclass.h"
 #include "devices/communication/lxicommunicator.h"
+#include "devices/communication/mockcommunicator.h"
+#include "devices/simulation/instrumentsimulator.h"
+#include "devices/simulation/fakeserialdevice.h"
+#include "devices/simulation/fakethermoraspserver.h"
 #include "devices/environment/JulaboFP50.h"
 #include "devices/environment/HuberPetiteFleur.h"
 #include "general/BurnInException.h"
+#include "general/devicepoller.h"
+#include "general/pollscheduler.h"
+#include "general/datarecorder.h"
+#include "general/samplehub.h"
 
-const unsigned int DEVICE_REFRESH_INTERVAL = 1; // s
+const unsigned int DEVICE_REFRESH_INTERVAL = 1000; // ms, used if a device has no pollInterval
+const qint64 RECORDER_MAX_FILE_SIZE = 256; // MiB, used if the Recorder has no maxFileSize
 
 SystemControllerClass::SystemControllerClass()
 {
-    _refreshThread = nullptr;
+    _scheduler = nullptr;
+    _recorder = nullptr;
+    _sampleHub = nullptr;
+    _stateTable = nullptr;
+    _recorderMaxFileSize = RECORDER_MAX_FILE_SIZE * 1024 * 1024;
 }
 
 SystemControllerClass::~SystemControllerClass() {
     _deleteAllDevices();
 }
 
-void SystemControllerClass::initialize() {
-    for(auto &i: _devices){
-        i.second->initialize();
+std::vector<DeviceInitResult> SystemControllerClass::initialize(int timeout) {
+    // Record the values read during initialization as well
+    _createRecorder();
+    _failedDevices.clear();
+    
+    // All devices are initialized at the same time, each one on its own
+    // thread. A device that doesn't finish in time is left to its thread.
+    // The results are shared with it, as it might still finish later.
+    struct Pending {
+        std::string id;
+        std::shared_ptr<DeviceInitResult> result;
+        std::future<void> done;
+    };
+    QElapsedTimer clock;
+    clock.start();
+    std::vector<Pending> pending;
+    for (const auto& dev: _devices) {
+        GenericInstrumentClass* device = dev.second;
+        auto result = std::make_shared<DeviceInitResult>();
+        result->id = dev.first;
+        result->ok = false;
+        result->duration = 0;
+        auto done = std::make_shared<std::promise<void>>();
+        pending.push_back({dev.first, result, done->get_future()});
+        device->getContext()->post([device, result, done]() {
+            QElapsedTimer deviceClock;
+            deviceClock.start();
+            try {
+                device->initialize();
+                result->ok = true;
+            } catch (const std::exception& e) {
+                // Not only BurnInException, e.g. parsing an invalid answer
+                result->error = e.what();
+            } catch (...) {
+                result->error = "Unknown error";
+            }
+            result->duration = deviceClock.elapsed();
+            done->set_value();
+        });
+    }
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    std::vector<DeviceInitResult> results;
+    for (auto& entry: pending) {
+        if (entry.done.wait_until(deadline) == std::future_status::ready)
+            results.push_back(*entry.result);
+        else {
+            DeviceInitResult result;
+            result.id = entry.id;
+            result.ok = false;
+            result.duration = clock.elapsed();
+            result.error = "No answer within " + std::to_string(timeout) + " ms";
+            results.push_back(result);
+        }
+        if (not results.back().ok)
+            _failedDevices.insert(entry.id);
     }
+    
+    qInfo("Initialized %zu of %zu devices in %lld ms", results.size() - _failedDevices.size(),
+        results.size(), clock.elapsed());
+    for (const auto& result: results) {
+        if (result.ok)
+            qInfo("  %s: %lld ms", result.id.c_str(), result.duration);
+        else
+            qCritical("  %s: failed after %lld ms: %s", result.id.c_str(), result.duration, result.error.c_str());
+    }
+    if (not results.empty() and _failedDevices.size() == results.size())
+        throw BurnInException("None of the devices could be initialized");
+    
+    // What the devices read while initializing becomes visible at once
+    if (_stateTable)
+        emit statePublished(_stateTable->publishAll());
+    
+    // Only the devices that are ready are polled
+    _createScheduler();
+    
+    return results;
+}
+
+bool SystemControllerClass::hasFailed(const GenericInstrumentClass* device) const {
+    return _failedDevices.count(getId(device)) > 0;
+}
+
+std::vector<std::string> SystemControllerClass::getFailedDevices() const {
+    return std::vector<std::string>(_failedDevices.begin(), _failedDevices.end());
 }
 
 std::vector<GenericInstrumentClass*> SystemControllerClass::getDevices() const {
@@ -50,6 +152,13 @@ std::string SystemControllerClass::getId(const GenericInstrumentClass* device) c
     return "";
 }
 
+std::string SystemControllerClass::getAttribute(const GenericInstrumentClass* device, const std::string& name, const std::string& defaultValue) const {
+    std::string id = getId(device);
+    if (_attributes.count(id) == 0 or _attributes.at(id).count(name) == 0)
+        return defaultValue;
+    return _attributes.at(id).at(name);
+}
+
 GenericInstrumentClass* SystemControllerClass::getDeviceById(std::string id) const {
     if (_devices.count(id) > 0)
         return _devices.at(id);
@@ -97,22 +206,27 @@ std::string SystemControllerClass::_buildId(const InstrumentDescription& desc) c
     return ident;
 }
 
-ControlTTiPower* SystemControllerClass::_constructTTiPower(const InstrumentDescription& desc) const {
-    std::string address = desc.attrs.at("address");
-    if (address == "")
-        throw BurnInException("Invalid address for a TTi power source:" + address);
-    int port;
-    std::vector<double> cVolt(2, 0);
-    std::vector<double> cCurr(2, 0);
-    
-    if (desc.attrs.count("port") == 0)
-        throw BurnInException("TTi is missing port number.");
-    try {
-        port = stoi(desc.attrs.at("port"));
-    } catch (logic_error) {
-        throw BurnInException("Invalid port number for TTi.");
+ControlTTiPower* SystemControllerClass::_constructTTiPower(const InstrumentDescription& desc) {
+    Communicator* comm; // Gets deleted by ControlTTiPower destructor
+    if (_isSimulated(desc)) {
+        int latency = _getSimulationTime(desc, "simlatency");
+        int jitter = _getSimulationTime(desc, "simjitter");
+        comm = new MockCommunicator(new TTiSimulator(), latency, jitter);
+    } else {
+        std::string address = desc.attrs.at("address");
+        if (address == "")
+            throw BurnInException("Invalid address for a TTi power source:" + address);
+        int port;
+        
+        if (desc.attrs.count("port") == 0)
+            throw BurnInException("TTi is missing port number.");
+        try {
+            port = stoi(desc.attrs.at("port"));
+        } catch (logic_error) {
+            throw BurnInException("Invalid port number for TTi.");
+        }
+        comm = new LXICommunicator(address, port, true);
     }
-    LXICommunicator* comm = new LXICommunicator(address, port, true); // Gets deleted by ControlTTiPower destructor
     ControlTTiPower* tti;
     try {
         tti = new ControlTTiPower(comm);
@@ -138,8 +252,12 @@ ControlTTiPower* SystemControllerClass::_constructTTiPower(const InstrumentDescr
     return tti;
 }
 
-ControlKeithleyPower* SystemControllerClass::_constructKeithleyPower(const InstrumentDescription& desc) const {
-    std::string address = desc.attrs.at("address");
+ControlKeithleyPower* SystemControllerClass::_constructKeithleyPower(const InstrumentDescription& desc) {
+    std::string address;
+    if (_isSimulated(desc))
+        address = _startFakeSerialDevice(new KeithleySimulator(), desc);
+    else
+        address = desc.attrs.at("address");
     if (address == "")
         throw BurnInException("Invalid address for a Keithley power supply: \"" + address + "\"");
     
@@ -158,21 +276,28 @@ ControlKeithleyPower* SystemControllerClass::_constructKeithleyPower(const Instr
     return new ControlKeithleyPower(address, cSetVolt, cSetCurr);
 }
 
-Kepco* SystemControllerClass::_constructKepco(const InstrumentDescription &desc) const {
-    std::string address = desc.attrs.at("address");
-    if (address == "")
-        throw BurnInException("Invalid address for a Kepco power supply: \"" + address + "\"");
-    
-    int port;
-    if (desc.attrs.count("port") == 0)
-        throw BurnInException("TTi is missing port number.");
-    try {
-        port = stoi(desc.attrs.at("port"));
-    } catch (logic_error) {
-        throw BurnInException("Invalid port number for TTi.");
+Kepco* SystemControllerClass::_constructKepco(const InstrumentDescription &desc) {
+    Communicator* comm; // Gets deleted by Kepco destructor
+    if (_isSimulated(desc)) {
+        int latency = _getSimulationTime(desc, "simlatency");
+        int jitter = _getSimulationTime(desc, "simjitter");
+        comm = new MockCommunicator(new KepcoSimulator(), latency, jitter);
+    } else {
+        std::string address = desc.attrs.at("address");
+        if (address == "")
+            throw BurnInException("Invalid address for a Kepco power supply: \"" + address + "\"");
+        
+        int port;
+        if (desc.attrs.count("port") == 0)
+            throw BurnInException("TTi is missing port number.");
+        try {
+            port = stoi(desc.attrs.at("port"));
+        } catch (logic_error) {
+            throw BurnInException("Invalid port number for TTi.");
+        }
+        comm = new LXICommunicator(address, port, true);
     }
     
-    LXICommunicator* comm = new LXICommunicator(address, port, true); // Gets deleted by Kepco destructor
     Kepco* kepco;
     try {
         kepco = new Kepco(comm);
@@ -210,7 +335,10 @@ void SystemControllerClass::_addHighVoltageSource(const InstrumentDescription& d
     
     std::string ident = _buildId(desc);
     _devices[ident] = dev;
+    _pollIntervals[ident] = desc.pollInterval;
+    _attributes[ident] = desc.attrs;
     _highVoltageSources.push_back(dev);
+    _setupChangeFilter(dev, desc);
 }
 
 void SystemControllerClass::_addLowVoltageSource(const InstrumentDescription& desc) {
@@ -227,19 +355,30 @@ void SystemControllerClass::_addLowVoltageSource(const InstrumentDescription& de
     
     std::string ident = _buildId(desc);
     _devices[ident] = dev;
+    _pollIntervals[ident] = desc.pollInterval;
+    _attributes[ident] = desc.attrs;
     _lowVoltageSources.push_back(dev);
+    _setupChangeFilter(dev, desc);
 }
 
 void SystemControllerClass::_addChiller(const InstrumentDescription& desc) {
     Chiller* chiller;
     if (desc.attrs.at("class") == "JulaboFP50") {
-        std::string address = desc.attrs.at("address");
+        std::string address;
+        if (_isSimulated(desc))
+            address = _startFakeSerialDevice(new JulaboSimulator(), desc);
+        else
+            address = desc.attrs.at("address");
         if (address == "")
             throw BurnInException("Invalid address for Chiller device JulaboFP50: " + address);
 
         chiller = new JulaboFP50(address);
     } else if (desc.attrs.at("class") == "HuberPetiteFleur") {
-        std::string address = desc.attrs.at("address");
+        std::string address;
+        if (_isSimulated(desc))
+            address = _startFakeSerialDevice(new HuberSimulator(), desc);
+        else
+            address = desc.attrs.at("address");
         if (address == "")
             throw BurnInException("Invalid address for Chiller device HuberPetiteFleur: " + address);
 
@@ -251,7 +390,10 @@ void SystemControllerClass::_addChiller(const InstrumentDescription& desc) {
     
     std::string ident = _buildId(desc);
     _devices[ident] = chiller;
+    _pollIntervals[ident] = desc.pollInterval;
+    _attributes[ident] = desc.attrs;
     _chillers.push_back(chiller);
+    _setupChangeFilter(chiller, desc);
 }
 
 void SystemControllerClass::_addThermorasp(const InstrumentDescription& desc) {
@@ -261,21 +403,44 @@ void SystemControllerClass::_addThermorasp(const InstrumentDescription& desc) {
     
     if (desc.attrs.at("class") == "Thermorasp") {
         quint16 port;
-        std::string address = desc.attrs.at("address");
-        if (address == "")
-            throw BurnInException("Invalid address for Thermorasp device: " + address);
-        try {
-            port = stoi(desc.attrs.at("port"));
-        } catch (logic_error) {
-            throw BurnInException("Invalid port number for Thermorasp.");
+        std::string address;
+        bool streaming = desc.attrs.count("stream") != 0 and desc.attrs.at("stream") == "true";
+        if (_isSimulated(desc)) {
+            std::vector<std::string> names;
+            for (const auto& opset: desc.settings)
+                names.push_back(opset.at("name"));
+            // A streaming server sends readings as often as they are polled otherwise
+            int interval = 0;
+            if (streaming)
+                interval = desc.pollInterval ? desc.pollInterval : DEVICE_REFRESH_INTERVAL;
+            int latency = _getSimulationTime(desc, "simlatency");
+            int jitter = _getSimulationTime(desc, "simjitter");
+            FakeThermoraspServer* server = new FakeThermoraspServer(names, interval, latency, jitter);
+            _simulators.push_back(server);
+            server->start();
+            address = "127.0.0.1";
+            port = server->getPort();
+        } else {
+            address = desc.attrs.at("address");
+            if (address == "")
+                throw BurnInException("Invalid address for Thermorasp device: " + address);
+            try {
+                port = stoi(desc.attrs.at("port"));
+            } catch (logic_error) {
+                throw BurnInException("Invalid port number for Thermorasp.");
+            }
         }
         Thermorasp* rasp = new Thermorasp(address, port);
         _thermorasps.push_back(rasp);
         std::string ident = _buildId(desc);
         _devices[ident] = rasp;
+        _pollIntervals[ident] = desc.pollInterval;
+        _attributes[ident] = desc.attrs;
 
         for (const auto& opset: desc.settings)
             rasp->addSensorName(opset.at("name"));
+        
+        rasp->setStreaming(streaming);
     } else {
         throw BurnInException("Invalid class \"" + desc.attrs.at("class")
             + "\" for a Thermorasp device. Valid classes are: Thermorasp");
@@ -307,14 +472,118 @@ void SystemControllerClass::_addDAQModule(const InstrumentDescription& desc) {
     _daqModules.push_back(daqmodule);
 }
 
-void SystemControllerClass::_deleteAllDevices() {
-    if (_refreshThread) {
-        // Stop refresh thread
-        _refreshThread->quit();
-        _refreshThread->wait();
-        delete _refreshThread;
-        _refreshThread = nullptr;
+void SystemControllerClass::_setRecorder(const InstrumentDescription& desc) {
+    _recorderDirectory = desc.attrs.at("directory");
+    if (_recorderDirectory == "")
+        throw BurnInException("Invalid directory for Recorder");
+    
+    _recorderMaxFileSize = RECORDER_MAX_FILE_SIZE * 1024 * 1024;
+    if (desc.attrs.count("maxfilesize") > 0) {
+        bool ok;
+        qint64 size = QString::fromStdString(desc.attrs.at("maxfilesize")).toLongLong(&ok);
+        if (not ok or size <= 0)
+            throw BurnInException("Invalid maxFileSize \"" + desc.attrs.at("maxfilesize") + "\" for Recorder. Needs to be a positive number of MiB");
+        _recorderMaxFileSize = size * 1024 * 1024;
     }
+}
+
+bool SystemControllerClass::_isSimulated(const InstrumentDescription& desc) const {
+    return desc.attrs.count("simulate") != 0 and desc.attrs.at("simulate") == "true";
+}
+
+std::map<std::string, double> SystemControllerClass::_parseDeadbands(const InstrumentDescription& desc, const std::string& attr) const {
+    // Either "0.01" for all quantities or e.g. "voltage:0.01 current:1e-6"
+    std::map<std::string, double> deadbands;
+    if (desc.attrs.count(attr) == 0)
+        return deadbands;
+    QStringList entries = QString::fromStdString(desc.attrs.at(attr)).split(QRegularExpression("[\\s,]+"), QString::SkipEmptyParts);
+    for (const auto& entry: entries) {
+        std::string quantity;
+        QString value = entry;
+        int colon = entry.indexOf(':');
+        if (colon >= 0) {
+            quantity = entry.left(colon).toStdString();
+            value = entry.mid(colon + 1);
+        }
+        bool ok;
+        double deadband = value.toDouble(&ok);
+        if (not ok or deadband < 0 or (colon >= 0 and quantity == ""))
+            throw BurnInException("Invalid " + attr + " \"" + desc.attrs.at(attr) + "\". Needs to be a number or a list like \"voltage:0.01 current:1e-6\"");
+        deadbands[quantity] = deadband;
+    }
+    return deadbands;
+}
+
+void SystemControllerClass::_setupChangeFilter(GenericInstrumentClass* device, const InstrumentDescription& desc) {
+    ChangeFilter* filter = device->getChangeFilter();
+    std::map<std::string, double> absolute = _parseDeadbands(desc, "deadband");
+    std::map<std::string, double> relative = _parseDeadbands(desc, "relativedeadband");
+    
+    // An empty quantity stands for all quantities without one of their own
+    Deadband defaults = filter->getDeadband("");
+    if (absolute.count("") > 0)
+        defaults.absolute = absolute.at("");
+    if (relative.count("") > 0)
+        defaults.relative = relative.at("");
+    filter->setDefaultDeadband(defaults.absolute, defaults.relative);
+    
+    std::set<std::string> quantities;
+    for (const auto& entry: absolute)
+        quantities.insert(entry.first);
+    for (const auto& entry: relative)
+        quantities.insert(entry.first);
+    for (const auto& quantity: quantities) {
+        if (quantity == "")
+            continue;
+        Deadband deadband = defaults;
+        if (absolute.count(quantity) > 0)
+            deadband.absolute = absolute.at(quantity);
+        if (relative.count(quantity) > 0)
+            deadband.relative = relative.at(quantity);
+        filter->setDeadband(quantity, deadband.absolute, deadband.relative);
+    }
+    
+    if (desc.attrs.count("heartbeat") > 0) {
+        bool ok;
+        int heartbeat = QString::fromStdString(desc.attrs.at("heartbeat")).toInt(&ok);
+        if (not ok or heartbeat < 0)
+            throw BurnInException("Invalid heartbeat \"" + desc.attrs.at("heartbeat") + "\". Needs to be a number of milliseconds");
+        filter->setHeartbeat(heartbeat);
+    }
+}
+
+int SystemControllerClass::_getSimulationTime(const InstrumentDescription& desc, const std::string& attr) const {
+    if (desc.attrs.count(attr) == 0)
+        return 0;
+    bool ok;
+    int time = QString::fromStdString(desc.attrs.at(attr)).toInt(&ok);
+    if (not ok or time < 0)
+        throw BurnInException("Invalid " + attr + " \"" + desc.attrs.at(attr) + "\". Needs to be a number of milliseconds");
+    return time;
+}
+
+std::string SystemControllerClass::_startFakeSerialDevice(InstrumentSimulator* simulator, const InstrumentDescription& desc) {
+    int latency, jitter;
+    try {
+        latency = _getSimulationTime(desc, "simlatency");
+        jitter = _getSimulationTime(desc, "simjitter");
+    } catch (...) {
+        delete simulator;
+        throw;
+    }
+    FakeSerialDevice* device = new FakeSerialDevice(simulator, latency, jitter);
+    _simulators.push_back(device);
+    device->start();
+    qInfo("Simulating %s on %s", desc.attrs.at("class").c_str(), device->getPortName().c_str());
+    return device->getPortName();
+}
+
+void SystemControllerClass::_deleteAllDevices() {
+    // Stop refreshing. Waits for running polls to finish
+    _deleteScheduler();
+    _deleteRecorder();
+    _deleteSampleHub();
+    _recorderDirectory.clear();
     
     // Clear vectors and pointers
     qDebug("Removing devices");
@@ -324,11 +593,22 @@ void SystemControllerClass::_deleteAllDevices() {
     _lowVoltageSources.clear();
     _highVoltageSources.clear();
     _daqModules.clear();
+    _pollIntervals.clear();
+    _attributes.clear();
+    _failedDevices.clear();
+    
+    // Finish the operations still queued before deleting the devices
+    for (const auto& dev: _devices)
+        dev.second->getContext()->stop();
     
     // Delete all device instances
     for (const auto& dev: _devices)
         delete dev.second;
     _devices.clear();
+    
+    // Simulated devices go last, the drivers might still talk to them
+    qDeleteAll(_simulators);
+    _simulators.clear();
 }
 
 void SystemControllerClass::setupFromDesc(const std::vector<InstrumentDescription>& descs) {
@@ -350,6 +630,11 @@ void SystemControllerClass::setupFromDesc(const std::vector<InstrumentDescriptio
                     qWarning("Already have one DAQ module. Ignoring others");
                 else
                     _addDAQModule(desc);
+            } else if (type == "recorder") {
+                if (_recorderDirectory != "")
+                    qWarning("Already have one Recorder. Ignoring others");
+                else
+                    _setRecorder(desc);
             } else
                 Q_ASSERT(false); // Should not reach
         }
@@ -357,6 +642,13 @@ void SystemControllerClass::setupFromDesc(const std::vector<InstrumentDescriptio
         if (_daqModules.size() == 0)
             qWarning("No DAQ module was found in config.");
         
+        for (const auto& dev: _devices)
+            dev.second->getContext()->setName(dev.first);
+        
+        // The hub exists from now on, so that its consumers can be set
+        // up before the devices publish their first readings
+        _createSampleHub();
+        
     } catch (const BurnInException& e) {
         _deleteAllDevices();
         
@@ -364,30 +656,232 @@ void SystemControllerClass::setupFromDesc(const std::vector<InstrumentDescriptio
     }
 }
 
-void SystemControllerClass::_refreshingReadings() {
-    for (const auto& source: _lowVoltageSources)
-        source->refreshAppliedValues();
-    for (const auto& source: _highVoltageSources)
-        source->refreshAppliedValues();
-    for (const auto& chiller: _chillers)
-        chiller->refreshDeviceState();
-    for (const auto& rasp: _thermorasps)
-        rasp->fetchReadings(500);
+void SystemControllerClass::_createScheduler() {
+    _deleteScheduler();
+    _scheduler = new PollScheduler();
+    
+    // Every device is polled on the thread of its context and at its own
+    // interval. While its connection is lost, it is reconnected instead.
+    // Afterwards its readings are published to the state table at once
+    for (const auto& source: getVoltageSources()) {
+        std::string ident = getId(source);
+        if (_failedDevices.count(ident) > 0)
+            continue;
+        _scheduler->addPoller(new DevicePoller(ident, _publishAfter(source, [source]() {
+            source->refreshAppliedValues();
+        }), source->getContext()), _getPollInterval(ident));
+    }
+    for (const auto& chiller: _chillers) {
+        std::string ident = getId(chiller);
+        if (_failedDevices.count(ident) > 0)
+            continue;
+        _scheduler->addPoller(new DevicePoller(ident, _publishAfter(chiller, [chiller]() {
+            chiller->refreshDeviceState();
+        }), chiller->getContext()), _getPollInterval(ident));
+    }
+    for (const auto& rasp: _thermorasps) {
+        std::string ident = getId(rasp);
+        if (_failedDevices.count(ident) > 0)
+            continue;
+        _scheduler->addPoller(new DevicePoller(ident, _publishAfter(rasp, [rasp]() {
+            rasp->fetchReadings(500);
+        }), rasp->getContext()), _getPollInterval(ident));
+    }
+}
+
+void SystemControllerClass::_deleteScheduler() {
+    if (_scheduler) {
+        delete _scheduler;
+        _scheduler = nullptr;
+    }
+}
+
+unsigned int SystemControllerClass::_getPollInterval(const std::string& ident) const {
+    if (_pollIntervals.count(ident) == 0 or _pollIntervals.at(ident) == 0)
+        return DEVICE_REFRESH_INTERVAL;
+    else
+        return _pollIntervals.at(ident);
+}
+
+void SystemControllerClass::_createSampleHub() {
+    // The recorder takes its samples from the hub
+    _deleteRecorder();
+    _deleteSampleHub();
+    _sampleHub = new SampleHub();
+    SampleHub* hub = _sampleHub;
+    
+    // The readings are published on the threads of the device contexts.
+    // This needs to be known before the first sample is published
+    for (const auto& dev: _devices)
+        hub->addProducer(dev.second->getContext()->getThread());
+    
+    for (const auto& dev: _devices) {
+        quint32 channel = hub->addChannel(getChannelName(dev.second, "connected"));
+        connect(dev.second, &GenericInstrumentClass::connectionStateChanged, hub, [hub, channel](bool connected) {
+            hub->publish(channel, connected ? 1 : 0);
+        }, Qt::DirectConnection);
+    }
+    
+    for (const auto& source: getVoltageSources()) {
+        _publishReadings(source, "voltage", source->getNumOutputs());
+        _publishReadings(source, "current", source->getNumOutputs());
+        _publishOutputs(source, &PowerControlClass::voltSetChanged, "voltage_set");
+        _publishOutputs(source, &PowerControlClass::currSetChanged, "current_limit");
+        
+        std::vector<quint32> channels;
+        for (int i = 1; i <= source->getNumOutputs(); ++i)
+            channels.push_back(hub->addChannel(getChannelName(source, "power", i)));
+        connect(source, &PowerControlClass::powerStateChanged, hub, [hub, channels](bool state, int id) {
+            if (id >= 1 and id <= static_cast<int>(channels.size()))
+                hub->publish(channels[id - 1], state ? 1 : 0);
+        }, Qt::DirectConnection);
+    }
+    for (const auto& chiller: _chillers) {
+        _publishReadings(chiller, "bath_temperature");
+        _publishReadings(chiller, "working_temperature");
+        _publishReadings(chiller, "circulator");
+    }
+    for (const auto& rasp: _thermorasps) {
+        std::vector<quint32> channels;
+        for (const auto& name: rasp->getSensorNames())
+            channels.push_back(hub->addChannel(getChannelName(rasp, name)));
+        connect(rasp, &Thermorasp::gotNewReadings, hub, [hub, channels](const ThermoraspReadings& readings) {
+            // NaN marks a sensor that gave no reading this time
+            for (int i = 0; i < readings.values.size() and i < static_cast<int>(channels.size()); ++i)
+                hub->publish(channels[i], readings.values[i]);
+        }, Qt::DirectConnection);
+    }
+    
+    // Readings are staged as they are published and become visible to
+    // readers of the table device by device
+    _stateTable = new StateTable(hub->getChannelNames().size());
+    hub->setStateTable(_stateTable);
+}
+
+std::function<void()> SystemControllerClass::_publishAfter(GenericInstrumentClass* device, std::function<void()> poll) {
+    std::string prefix = getId(device) + "/";
+    std::vector<quint32> channels;
+    std::vector<std::string> names = _sampleHub->getChannelNames();
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i].compare(0, prefix.size(), prefix) == 0)
+            channels.push_back(static_cast<quint32>(i));
+    }
+    
+    StateTable* table = _stateTable;
+    return [this, device, poll, table, channels]() {
+        try {
+            device->supervise(poll);
+        } catch (const BurnInException& e) {
+            // Whatever was read before the error is still current
+            emit statePublished(table->publish(channels));
+            throw;
+        }
+        emit statePublished(table->publish(channels));
+    };
+}
+
+void SystemControllerClass::_publishReadings(GenericInstrumentClass* device, const std::string& quantity, int numOutputs) {
+    // Every reading goes to the hub, so that the recorder and the state
+    // table get it even if the change filter holds it back
+    SampleHub* hub = _sampleHub;
+    std::map<int, quint32> channels; // By output
+    if (numOutputs == 0)
+        channels[0] = hub->addChannel(getChannelName(device, quantity));
+    for (int i = 1; i <= numOutputs; ++i)
+        channels[i] = hub->addChannel(getChannelName(device, quantity, i));
+    connect(device, &GenericInstrumentClass::readingTaken, hub,
+            [hub, quantity, channels](const std::string& readQuantity, int output, double value, bool reported) {
+        if (readQuantity != quantity or channels.count(output) == 0)
+            return;
+        hub->publish(channels.at(output), value, reported);
+    }, Qt::DirectConnection);
+}
+
+void SystemControllerClass::_publishOutputs(PowerControlClass* source, void (PowerControlClass::*signal)(double, int), const std::string& quantity) {
+    SampleHub* hub = _sampleHub;
+    std::vector<quint32> channels;
+    for (int i = 1; i <= source->getNumOutputs(); ++i)
+        channels.push_back(hub->addChannel(getChannelName(source, quantity, i)));
+    connect(source, signal, hub, [hub, channels](double value, int id) {
+        if (id >= 1 and id <= static_cast<int>(channels.size()))
+            hub->publish(channels[id - 1], value);
+    }, Qt::DirectConnection);
+}
+
+void SystemControllerClass::_deleteSampleHub() {
+    if (_sampleHub) {
+        // Disconnects the devices
+        delete _sampleHub;
+        _sampleHub = nullptr;
+    }
+    if (_stateTable) {
+        delete _stateTable;
+        _stateTable = nullptr;
+    }
+}
+
+void SystemControllerClass::_createRecorder() {
+    _deleteRecorder();
+    if (_recorderDirectory == "")
+        return;
+    
+    _recorder = new DataRecorder(_sampleHub, _recorderDirectory, _recorderMaxFileSize);
+    try {
+        _recorder->start();
+    } catch (const BurnInException& e) {
+        qCritical("Readings won't be recorded: %s", e.what());
+        _deleteRecorder();
+    }
+}
+
+void SystemControllerClass::_deleteRecorder() {
+    if (_recorder) {
+        // Writes what was recorded so far
+        delete _recorder;
+        _recorder = nullptr;
+    }
+}
+
+SampleHub* SystemControllerClass::getSampleHub() const {
+    return _sampleHub;
+}
+
+StateTable* SystemControllerClass::getStateTable() const {
+    return _stateTable;
+}
+
+StateSnapshot SystemControllerClass::snapshot() const {
+    if (_stateTable == nullptr)
+        return {0, 0, {}};
+    return _stateTable->snapshot();
+}
+
+int SystemControllerClass::getChannelId(const std::string& name) const {
+    if (_sampleHub == nullptr)
+        return -1;
+    std::vector<std::string> names = _sampleHub->getChannelNames();
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it == names.end())
+        return -1;
+    return static_cast<int>(it - names.begin());
+}
+
+PollScheduler* SystemControllerClass::getScheduler() const {
+    return _scheduler;
+}
+
+DataRecorder* SystemControllerClass::getRecorder() const {
+    return _recorder;
 }
 
 void SystemControllerClass::startRefreshingReadings() {
-    if (_refreshThread) {
-        _refreshThread->quit();
-        _refreshThread->wait();
-        delete _refreshThread;
-    }
-    
-    _refreshThread = new QThread(this);
-    QTimer* refreshTimer = new QTimer();
-    refreshTimer->moveToThread(_refreshThread);
-    refreshTimer->setInterval(DEVICE_REFRESH_INTERVAL * 1000);
-    connect(_refreshThread, &QThread::started, refreshTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
-    connect(_refreshThread, &QThread::finished, refreshTimer, &QObject::deleteLater);
-    connect(refreshTimer, &QTimer::timeout, this, &SystemControllerClass::_refreshingReadings, Qt::DirectConnection);
-    _refreshThread->start();
+    Q_ASSERT(_scheduler != nullptr);
+    _scheduler->start();
+}
+
+std::string SystemControllerClass::getChannelName(const GenericInstrumentClass* device, const std::string& quantity, int output) const {
+    std::string name = getId(device) + "/";
+    if (output > 0)
+        name += std::to_string(output) + "/";
+    return name + quantity;
 }
@@ -2,9 +2,11 @@
 #ifndef SYSTEMCONTROLLERCLASS_H
 #define SYSTEMCONTROLLERCLASS_H
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 
 #include <QThread>
 
@@ -17,6 +19,20 @@
 #include "devices/environment/chiller.h"
 #include "devices/daq/daqmodule.h"
 #include "general/hwdescriptionparser.h"
+#include "general/statetable.h"
+
+class PollScheduler;
+class DataRecorder;
+class SampleHub;
+class InstrumentSimulator;
+
+// Outcome of initializing one device
+struct DeviceInitResult {
+    std::string id;
+    bool ok;
+    qint64 duration; // ms, until the device finished or the wait ended
+    std::string error; // Empty if ok
+};
 
 class SystemControllerClass:public QObject
 {
@@ -26,35 +42,131 @@ public:
     virtual ~SystemControllerClass();
     
     void setupFromDesc(const std::vector<InstrumentDescription>& descs);
-    void initialize();
+    /**
+     * Initialize all devices at the same time and log a summary. Devices
+     * that fail are left out of polling and can't be used in commands,
+     * the others are ready.
+     * @param timeout Time in ms to wait for the devices
+     * @return Result for each device
+     * @throw BurnInException if none of the devices could be initialized
+     */
+    std::vector<DeviceInitResult> initialize(int timeout = DEFAULT_INIT_TIMEOUT);
     void startRefreshingReadings();
     
+    /**
+     * @return Whether the device failed or timed out in the last
+     * initialize. false if it wasn't initialized yet
+     */
+    bool hasFailed(const GenericInstrumentClass* device) const;
+    std::vector<std::string> getFailedDevices() const;
+    
+    static constexpr int DEFAULT_INIT_TIMEOUT = 30000; // ms
+    
     std::vector<GenericInstrumentClass*> getDevices() const;
     std::string getId(const GenericInstrumentClass*) const;
     GenericInstrumentClass* getDeviceById(std::string id) const;
     
+    /**
+     * @param name Attribute of the device in the hardware description,
+     *     lowercase
+     * @return Value of the attribute or defaultValue if it isn't set
+     */
+    std::string getAttribute(const GenericInstrumentClass* device, const std::string& name, const std::string& defaultValue = "") const;
+    
     std::vector<Thermorasp*> getThermorasps() const;
     std::vector<Chiller*> getChillers() const;
     std::vector<PowerControlClass*> getVoltageSources() const;
     std::vector<PowerControlClass*> getLowVoltageSources() const;
     std::vector<PowerControlClass*> getHighVoltageSources() const;
     std::vector<DAQModule*> getDaqModules() const;
+    
+    /**
+     * @return The recorder of the readings or nullptr if there is no
+     * Recorder tag in the hardware description or if the devices
+     * haven't been initialized
+     */
+    DataRecorder* getRecorder() const;
+    
+    /**
+     * @return The hub all readings are published to or nullptr if no
+     * devices have been set up
+     */
+    SampleHub* getSampleHub() const;
+    
+    /**
+     * @return The scheduler polling the devices or nullptr if the
+     * devices haven't been initialized
+     */
+    PollScheduler* getScheduler() const;
+    
+    /**
+     * @param device The device
+     * @param quantity What is measured, e.g. voltage or the name of a sensor
+     * @param output Output of a voltage source, 0 for other devices
+     * @return Name of the channel of the hub, e.g. TTi1/1/voltage
+     */
+    std::string getChannelName(const GenericInstrumentClass* device, const std::string& quantity, int output = 0) const;
+    
+    /**
+     * @param name Name of the channel, see getChannelName
+     * @return Id of the channel of the hub or -1 if there is none
+     */
+    int getChannelId(const std::string& name) const;
+    
+    /**
+     * @return The latest values of all channels of the hub or nullptr if
+     * no devices have been set up. The values of a device are published
+     * together after every poll of it
+     */
+    StateTable* getStateTable() const;
+    
+    /**
+     * @return Copy of the latest values of all channels, without channels
+     * if no devices have been set up. Consistent per device, see
+     * StateTable. Never blocks
+     */
+    StateSnapshot snapshot() const;
+
+signals:
+    /**
+     * The state table changed. Emitted on the thread of the device that
+     * was polled
+     * @param sequence Number of publishes so far
+     */
+    void statePublished(quint64 sequence);
 
 private:
     string _buildId(const InstrumentDescription& desc) const;
     
     void _deleteAllDevices();
     
-    ControlTTiPower* _constructTTiPower(const InstrumentDescription& desc) const;
-    ControlKeithleyPower* _constructKeithleyPower(const InstrumentDescription& desc) const;
-    Kepco* _constructKepco(const InstrumentDescription& desc) const;
+    ControlTTiPower* _constructTTiPower(const InstrumentDescription& desc);
+    ControlKeithleyPower* _constructKeithleyPower(const InstrumentDescription& desc);
+    Kepco* _constructKepco(const InstrumentDescription& desc);
     void _addHighVoltageSource(const InstrumentDescription& desc);
     void _addLowVoltageSource(const InstrumentDescription& desc);
     void _addChiller(const InstrumentDescription& desc);
     void _addThermorasp(const InstrumentDescription& desc);
     void _addDAQModule(const InstrumentDescription& desc);
+    void _setRecorder(const InstrumentDescription& desc);
+    
+    bool _isSimulated(const InstrumentDescription& desc) const;
+    int _getSimulationTime(const InstrumentDescription& desc, const std::string& attr) const;
+    std::map<std::string, double> _parseDeadbands(const InstrumentDescription& desc, const std::string& attr) const;
+    void _setupChangeFilter(GenericInstrumentClass* device, const InstrumentDescription& desc);
+    std::string _startFakeSerialDevice(InstrumentSimulator* simulator, const InstrumentDescription& desc);
     
-    void _refreshingReadings();
+    void _createScheduler();
+    void _deleteScheduler();
+    unsigned int _getPollInterval(const std::string& ident) const;
+    
+    void _createSampleHub();
+    std::function<void()> _publishAfter(GenericInstrumentClass* device, std::function<void()> poll);
+    void _deleteSampleHub();
+    void _publishReadings(GenericInstrumentClass* device, const std::string& quantity, int numOutputs = 0);
+    void _publishOutputs(PowerControlClass* source, void (PowerControlClass::*signal)(double, int), const std::string& quantity);
+    void _createRecorder();
+    void _deleteRecorder();
     
     std::map<string , GenericInstrumentClass*> _devices;
     std::vector<Thermorasp*> _thermorasps;
@@ -63,7 +175,20 @@ private:
     std::vector<PowerControlClass*> _highVoltageSources;
     std::vector<DAQModule*> _daqModules;
     
-    QThread* _refreshThread;
+    std::map<string, unsigned int> _pollIntervals; // ms, 0 for default
+    std::map<string, std::map<string, string>> _attributes; // From the hardware description
+    std::set<string> _failedDevices; // Ids of the devices that failed to initialize
+    
+    // Fake serial devices and servers of simulated devices
+    std::vector<QObject*> _simulators;
+    
+    PollScheduler* _scheduler;
+    
+    std::string _recorderDirectory; // Empty if nothing is recorded
+    qint64 _recorderMaxFileSize; // bytes
+    DataRecorder* _recorder;
+    SampleHub* _sampleHub;
+    StateTable* _stateTable;
 
 };
 
@@ -1,7 +1,9 @@
 #include "commanddisplayer.h"
 
 void CommandDisplayer::handleCommand(BurnInWaitCommand& command) {
-    if (command.wait == 1)
+    if (not command.variable.isEmpty())
+        display = "Wait for $" + command.variable + " seconds";
+    else if (command.wait == 1)
         display = "Wait for 1 second";
     else
         display = "Wait for " + QString::number(command.wait) + " seconds";
@@ -21,7 +23,8 @@ void CommandDisplayer::handleCommand(BurnInVoltageSourceSetCommand& command) {
     QString output_name = "";
     if (command.source->getNumOutputs() > 1)
         output_name = " output no. " + QString::number(command.output);
-    display = "Set source " + command.sourceName + output_name + " to " + QString::number(command.value) + " volts";
+    QString value = command.variable.isEmpty() ? QString::number(command.value) : "$" + command.variable;
+    display = "Set source " + command.sourceName + output_name + " to " + value + " volts";
 }
 
 void CommandDisplayer::handleCommand(BurnInChillerOutputCommand& command) {
@@ -32,9 +35,34 @@ void CommandDisplayer::handleCommand(BurnInChillerOutputCommand& command) {
 }
 
 void CommandDisplayer::handleCommand(BurnInChillerSetCommand& command) {
-    display = "Set chiller " + command.chillerName + " working temperature to " + QString::number(command.value) + " °C";
+    QString value = command.variable.isEmpty() ? QString::number(command.value) : "$" + command.variable;
+    display = "Set chiller " + command.chillerName + " working temperature to " + value + " °C";
 }
 
 void CommandDisplayer::handleCommand(BurnInDAQCommand& command) {
     display = "Execute DAQ ACF command " + command.execName + " " + command.opts;
 }
+
+void CommandDisplayer::handleCommand(BurnInParallelCommand& command) {
+    display = "In parallel: " + _displayAll(command.commands);
+}
+
+void CommandDisplayer::handleCommand(BurnInRepeatCommand& command) {
+    display = "Repeat " + QString::number(command.count) + " times: " + _displayAll(command.commands);
+}
+
+void CommandDisplayer::handleCommand(BurnInForCommand& command) {
+    display = "For $" + command.variable + " from " + QString::number(command.start)
+        + " to " + QString::number(command.stop) + " in steps of " + QString::number(command.step)
+        + ": " + _displayAll(command.commands);
+}
+
+QString CommandDisplayer::_displayAll(const QVector<BurnInCommand*>& commands) {
+    QStringList parts;
+    for (const auto& command: commands) {
+        CommandDisplayer displayer;
+        command->accept(displayer);
+        parts.append(displayer.display);
+    }
+    return parts.join("; ");
+}
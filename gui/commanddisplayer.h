@@ -2,6 +2,7 @@
 #define COMMANDDISPLAYER_H
 
 #include <QString>
+#include <QStringList>
 #include "general/burnincommand.h"
 
 
@@ -16,8 +17,15 @@ public:
     void handleCommand(BurnInChillerOutputCommand& command) override;
     void handleCommand(BurnInChillerSetCommand& command) override;
     void handleCommand(BurnInDAQCommand& command) override;
+    void handleCommand(BurnInParallelCommand& command) override;
+    void handleCommand(BurnInRepeatCommand& command) override;
+    void handleCommand(BurnInForCommand& command) override;
     
     QString display;
+    
+private:
+    // Displays a list of commands separated by semicolons
+    static QString _displayAll(const QVector<BurnInCommand*>& commands);
 };
 
 #endif // COMMANDDISPLAYER_H
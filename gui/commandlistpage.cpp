@@ -10,6 +10,7 @@
 #include "commandmodifydialog.h"
 #include "commanddisplayer.h"
 #include "general/BurnInException.h"
+#include "general/commandprogram.h"
 
 CommandListItem::CommandListItem(std::shared_ptr<BurnInCommand> command_, QListWidget *parent)
     : QListWidgetItem(parent), command(command_) {
@@ -133,6 +134,11 @@ void CommandListPage::setSystemController(const SystemControllerClass* controlle
             action = _add_command_menu->addAction("Execute a DAQ command");
             connect(action, SIGNAL(triggered()), this, SLOT(onAddDAQCmd()));
             break;
+        case COMMAND_PARALLEL:
+        case COMMAND_REPEAT:
+        case COMMAND_FOR:
+            // Only written in command files
+            break;
         }
     }
 }
@@ -375,7 +381,17 @@ void CommandListPage::onRunPressed() {
         commands.push_back(item->command.get());
     }
     
-    _rundialog = new CommandsRunDialog(commands, _controller, _commandListWidget->window());
+    CommandProgram program;
+    try {
+        program = CommandProgram::compile(commands, _controller);
+    } catch (BurnInException& e) {
+        qWarning("%s", e.what());
+        QMessageBox dialog(_commandListWidget->window());
+        dialog.critical(_commandListWidget->window(), "Error", "Can not run the commands: " + QString::fromStdString(e.what()));
+        return;
+    }
+    
+    _rundialog = new CommandsRunDialog(commands, program, _controller, _commandListWidget->window());
     
     connect(_rundialog, &CommandsRunDialog::finished, this, &CommandListPage::onRunFinished);
     
@@ -5,6 +5,7 @@
 #include <QSpinBox>
 #include <QComboBox>
 #include <QLineEdit>
+#include <QMessageBox>
 #include "devices/environment/JulaboFP50.h"
 
 CommandModifyDialog::CommandModifyDialog(QWidget *parent) :
@@ -291,6 +292,25 @@ void CommandModifyDialog::ModifyCommandHandler::handleCommand(BurnInDAQCommand&
     *ok = CommandModifyDialog::commandDAQCmd(parent, &command, controller);
 }
 
+void CommandModifyDialog::ModifyCommandHandler::handleCommand(BurnInParallelCommand& command) {
+    // One dialog after the other for the commands of the block
+    for (const auto& subcommand: command.commands) {
+        subcommand->accept(*this);
+        if (not *ok)
+            return;
+    }
+}
+
+void CommandModifyDialog::ModifyCommandHandler::handleCommand(BurnInRepeatCommand&) {
+    QMessageBox::information(parent, "Modify command", "Loops can only be changed in the command file.");
+    *ok = false;
+}
+
+void CommandModifyDialog::ModifyCommandHandler::handleCommand(BurnInForCommand&) {
+    QMessageBox::information(parent, "Modify command", "Loops can only be changed in the command file.");
+    *ok = false;
+}
+
 bool CommandModifyDialog::modifyCommand(QWidget *parent, BurnInCommand* command, const SystemControllerClass* controller) {
     bool ok;
     CommandModifyDialog::ModifyCommandHandler handler(parent, &ok, controller);
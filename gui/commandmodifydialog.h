@@ -51,6 +51,9 @@ private:
         void handleCommand(BurnInChillerOutputCommand& command) override;
         void handleCommand(BurnInChillerSetCommand& command) override;
         void handleCommand(BurnInDAQCommand& command) override;
+        void handleCommand(BurnInParallelCommand& command) override;
+        void handleCommand(BurnInRepeatCommand& command) override;
+        void handleCommand(BurnInForCommand& command) override;
         
         QWidget* parent;
         bool* ok;
@@ -2,214 +2,17 @@
 #include "ui_commandsrundialog.h"
 #include "gui/commanddisplayer.h"
 #include "general/BurnInException.h"
+#include "general/commandsimulator.h"
 
 #include <QMessageBox>
 #include <QScrollBar>
 #include <functional>
 #include <QString>
 
-CommandExecuter::CommandExecuter(const QVector<BurnInCommand*>& commands, const SystemControllerClass* controller, QWidget *parent) :
-    QObject(parent)
-{
-    _commands = commands;
-    _controller = controller;
-    _shouldAbort = false;
-    _shouldPause = false;
-    _isRunning = false;
-}
-
-void CommandExecuter::start() {
-    _shouldAbort = false;
-    _isRunning = true;
-    int n = 0;
-    for (const auto& command: _commands) {
-        CommandExecuteHandler handler(this, n, _controller);
-        emit commandStarted(n, QDateTime::currentDateTime());
-        command->accept(handler);
-        emit commandFinished(n, QDateTime::currentDateTime());
-        
-        if (handler.error)
-            break; // Halt on errors
-        
-        if (_shouldAbort)
-            break;
-        bool paused = false;
-        if (_shouldPause) {
-            emit commandStatusUpdate(n, "Paused");
-            paused = true;
-        }
-        while (_shouldPause)
-            QThread::msleep(100);
-        if (paused)
-            emit commandStatusUpdate(n, "Unpaused");
-        
-        ++n;
-    }
-    
-    _isRunning = false;
-    emit allFinished();
-}
-
-bool CommandExecuter::isPaused() const {
-    return _shouldPause;
-}
-
-bool CommandExecuter::isRunning() const {
-    return _isRunning;
-}
-
-void CommandExecuter::togglePause() {
-    _shouldPause = not _shouldPause;
-}
-
-void CommandExecuter::abort() {
-    _shouldAbort = true;
-    _isRunning = false;
-}
-
-CommandExecuter::CommandExecuteHandler::CommandExecuteHandler(CommandExecuter* executer, int n, const SystemControllerClass* controller) {
-    _executer = executer;
-    _n = n;
-    _controller = controller;
-    
-    error = false;
-}
-
-void CommandExecuter::CommandExecuteHandler::handleCommand(BurnInWaitCommand& command) {
-    unsigned int wait = command.wait;
-    emit _executer->commandStatusUpdate(_n, "Waiting");
-    while (not _executer->_shouldAbort and wait > 0) {
-        QThread::sleep(WAIT_INTERVAL);
-        wait -= WAIT_INTERVAL;
-    }
-    emit _executer->commandStatusUpdate(_n, "Wait finished");
-}
-
-void CommandExecuter::CommandExecuteHandler::handleCommand(BurnInVoltageSourceOutputCommand& command) {
-    if (command.on) {
-        emit _executer->commandStatusUpdate(_n, "Turning on output");
-        command.source->onPower(command.output);
-    } else {
-        emit _executer->commandStatusUpdate(_n, "Turning off output");
-        command.source->offPower(command.output);
-    }
-    
-    if (command.source->getPower(command.output)) {
-        if (not _executer->_shouldAbort)
-            _waitForVoltage(command.source, command.output);
-        emit _executer->commandStatusUpdate(_n, "Voltage source turned on. Voltage at set value.");
-    } else
-        emit _executer->commandStatusUpdate(_n, "Voltage source turned off.");
-}
-
-void CommandExecuter::CommandExecuteHandler::handleCommand(BurnInVoltageSourceSetCommand& command) {
-    emit _executer->commandStatusUpdate(_n, "Setting voltage");
-    command.source->setVolt(command.value, command.output);
-    
-    if (command.source->getPower(command.output)) {
-        if (not _executer->_shouldAbort)
-            _waitForVoltage(command.source, command.output);
-        emit _executer->commandStatusUpdate(_n, "Voltage applied");
-    } else
-        emit _executer->commandStatusUpdate(_n, "Voltage set. Voltage source output not turned on.");
-}
-
-void CommandExecuter::CommandExecuteHandler::_waitForVoltage(PowerControlClass* source, int output) {
-    emit _executer->commandStatusUpdate(_n, "Waiting for output to reach voltage");
-    
-    while (not _executer->_shouldAbort and 
-            std::abs(source->getVolt(output) - source->getVoltApp(output)) > VOLTAGESRC_EPSILON)
-        QThread::sleep(WAIT_INTERVAL);
-}
-
-void CommandExecuter::CommandExecuteHandler::handleCommand(BurnInChillerOutputCommand& command) {
-    Chiller* chiller = command.chiller;
-    if (chiller == nullptr) {
-        emit _executer->commandStatusUpdate(_n, "Error: No chiller connected");
-        error = true;
-        return;
-    }
-    
-    if (command.on) {
-        emit _executer->commandStatusUpdate(_n, "Turning chiller on");
-        if (not chiller->SetCirculatorOn()) {
-            emit _executer->commandStatusUpdate(_n, "Error: Could not turn on chiller");
-            error = true;
-            return;
-        }
-    } else {
-        emit _executer->commandStatusUpdate(_n, "Turning chiller off");
-        if (not chiller->SetCirculatorOff()) {
-            emit _executer->commandStatusUpdate(_n, "Error: Could not turn off chiller");
-            error = true;
-            return;
-        }
-    }
-    
-    if (chiller->GetCirculatorStatus()) {
-        _waitForChiller(chiller);
-        if (not _executer->_shouldAbort)
-            emit _executer->commandStatusUpdate(_n, "Chiller turned on. Bath at desired temperature");
-    } else
-        emit _executer->commandStatusUpdate(_n, "Chiller turned off");
-}
-
-void CommandExecuter::CommandExecuteHandler::handleCommand(BurnInChillerSetCommand& command) {
-    Chiller* chiller = command.chiller;
-    if (chiller == nullptr) {
-        emit _executer->commandStatusUpdate(_n, "Error: No chiller connected");
-        error = true;
-        return;
-    }
-    
-    emit _executer->commandStatusUpdate(_n, "Setting chiller temperature");
-    if (not chiller->SetWorkingTemperature(command.value)) {
-        emit _executer->commandStatusUpdate(_n, "Error: Could not set temperature");
-        error = true;
-        return;
-    }
-    
-    if (chiller->GetCirculatorStatus()) {
-        _waitForChiller(chiller);
-        if (not _executer->_shouldAbort)
-            emit _executer->commandStatusUpdate(_n, "Temperature set. Bath at desired temperature");
-    } else
-        emit _executer->commandStatusUpdate(_n, "Temperature set. Chiller not turned on");
-    
-}
-
-void CommandExecuter::CommandExecuteHandler::_waitForChiller(Chiller* chiller) {
-    emit _executer->commandStatusUpdate(_n, "Waiting for bath to reach temperature");
-    
-    while (not _executer->_shouldAbort and 
-            std::abs(chiller->GetBathTemperature() - chiller->GetWorkingTemperature()) > CHILLER_TEMP_EPSILON)
-        QThread::sleep(WAIT_INTERVAL);
-}
-
-void CommandExecuter::CommandExecuteHandler::handleCommand(BurnInDAQCommand& command) {
-    DAQModule* module = _controller->getDaqModules()[0];
-    if (module == nullptr) {
-        emit _executer->commandStatusUpdate(_n, "Error: No DAQ module connected");
-        error = true;
-        return;
-    }
-    
-    emit _executer->commandStatusUpdate(_n, "Running DAQ command");
-    try {
-        module->runACFBinary(command.execName, command.opts, true);
-    } catch (const BurnInException& e) {
-        emit _executer->commandStatusUpdate(_n, "Error: " + QString(e.what()));
-        error = true;
-        return;
-    }
-    emit _executer->commandStatusUpdate(_n, "DAQ command executed");
-}
-
-
-CommandsRunDialog::CommandsRunDialog(const QVector<BurnInCommand*>& commands, const SystemControllerClass* controller, QWidget *parent) :
+CommandsRunDialog::CommandsRunDialog(const QVector<BurnInCommand*>& commands, const CommandProgram& program, const SystemControllerClass* controller, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::CommandsRunDialog),
-    _executer(commands, controller)
+    _executer(program, controller)
 {
     _commands = commands;
     
@@ -229,6 +32,12 @@ CommandsRunDialog::CommandsRunDialog(const QVector<BurnInCommand*>& commands, co
     
     _setupDisplays(controller);
     
+    SimulationResult projection = CommandSimulator(program, controller).run();
+    qint64 minutes = static_cast<qint64>(projection.duration / 60);
+    _logMessage("Projected duration: " + QString::number(minutes / 60) + " h "
+        + QString::number(minutes % 60) + " min, peak high voltage: "
+        + QString::number(projection.peakHighVoltage) + " V");
+    
     _executer.moveToThread(&_executer_thread);
     connect(&_executer, SIGNAL(commandStarted(int, QDateTime)), this, SLOT(onCommandStarted(int, QDateTime)));
     connect(&_executer, SIGNAL(commandFinished(int, QDateTime)), this, SLOT(onCommandFinished(int, QDateTime)));
@@ -247,48 +56,76 @@ CommandsRunDialog::~CommandsRunDialog()
 void CommandsRunDialog::_setupDisplays(const SystemControllerClass* controller) {
     std::vector<PowerControlClass*> sources = controller->getVoltageSources();
     for (const auto& source: sources) {
-        QLabel* label = new QLabel();
         std::string name = controller->getId(source);
-        connect(source, &PowerControlClass::voltSetChanged, this, [this, label, source, name](double, int) {
-            this->_updateDisplayLabel(label, name, source);
+        size_t index = _displays.size();
+        _addDisplay([this, source, name]() {
+            return this->_displayText(name, source);
         });
-        connect(source, &PowerControlClass::powerStateChanged, this, [this, label, source, name](bool, int) {
-            this->_updateDisplayLabel(label, name, source);
+        connect(source, &PowerControlClass::voltSetChanged, this, [this, index](double, int) {
+            this->_displays[index].changed = true;
+        });
+        connect(source, &PowerControlClass::powerStateChanged, this, [this, index](bool, int) {
+            this->_displays[index].changed = true;
         });
-        ui->device_status_area->addWidget(label);
-        _updateDisplayLabel(label, name, source);
     }
     
     std::vector<Chiller*> chillers = controller->getChillers();
     for (const auto& chiller: chillers) {
-        QLabel* label = new QLabel();
         std::string name = controller->getId(chiller);
-        connect(chiller, &Chiller::workingTemperatureChanged, this, [this, label, chiller, name](float) {
-            this->_updateDisplayLabel(label, name, chiller);
+        // Later changes are taken from the signals instead of asking the
+        // chiller every time
+        chiller->getContext()->call([this, chiller]() {
+            _chillerStates[chiller] = {chiller->GetCirculatorStatus(), chiller->GetWorkingTemperature()};
+        });
+        size_t index = _displays.size();
+        _addDisplay([this, chiller, name]() {
+            return this->_displayText(name, chiller);
         });
-        connect(chiller, &Chiller::circulatorStatusChanged, this, [this, label, chiller, name](bool) {
-            this->_updateDisplayLabel(label, name, chiller);
+        connect(chiller, &Chiller::workingTemperatureChanged, this, [this, chiller, index](float temperature) {
+            this->_chillerStates[chiller].temperature = temperature;
+            this->_displays[index].changed = true;
         });
-        ui->device_status_area->addWidget(label);
-        _updateDisplayLabel(label, name, chiller);
+        connect(chiller, &Chiller::circulatorStatusChanged, this, [this, chiller, index](bool on) {
+            this->_chillerStates[chiller].on = on;
+            this->_displays[index].changed = true;
+        });
+    }
+    
+    connect(&_displayTimer, &QTimer::timeout, this, &CommandsRunDialog::onDisplayTimer);
+    _displayTimer.start(100);
+}
+
+void CommandsRunDialog::_addDisplay(std::function<QString()> text) {
+    QLabel* label = new QLabel();
+    label->setText(text());
+    ui->device_status_area->addWidget(label);
+    _displays.push_back({label, text, false});
+}
+
+void CommandsRunDialog::onDisplayTimer() {
+    for (auto& display: _displays) {
+        if (display.changed) {
+            display.changed = false;
+            display.label->setText(display.text());
+        }
     }
 }
 
-void CommandsRunDialog::_updateDisplayLabel(QLabel* label, std::string name, PowerControlClass* source) {
+QString CommandsRunDialog::_displayText(std::string name, PowerControlClass* source) const {
     QString line = QString::fromStdString(name) + ": \n";
     for (int i = 1; i <= source->getNumOutputs(); ++i) {
         if (i != 1)
             line += "\n";
         line += "    Output " + QString(source->getPower(i) ? "on" : "off") + ", " + QString::number(source->getVolt(i)) + " V";
     }
-    label->setText(line);
+    return line;
 }
 
-void CommandsRunDialog::_updateDisplayLabel(QLabel* label, std::string name, Chiller* chiller) {
-    QString line = QString::fromStdString(name) + ": \n"
-        + "    Circulator " + (chiller->GetCirculatorStatus() ? "on" : "off") + ", "
-        + QString::number(chiller->GetWorkingTemperature()) + " °C";
-    label->setText(line);
+QString CommandsRunDialog::_displayText(std::string name, const Chiller* chiller) const {
+    const ChillerState& state = _chillerStates.at(chiller);
+    return QString::fromStdString(name) + ": \n"
+        + "    Circulator " + (state.on ? "on" : "off") + ", "
+        + QString::number(state.temperature) + " °C";
 }
 
 void CommandsRunDialog::_logMessage(QString message) {
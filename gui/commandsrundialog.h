@@ -6,75 +6,30 @@
 #include <QDateTime>
 #include <QString>
 #include <QLabel>
+#include <QTimer>
 #include <atomic>
+#include <functional>
+#include <map>
+#include <vector>
 #include "general/burnincommand.h"
 #include "general/systemcontrollerclass.h"
+#include "general/commandexecuter.h"
+#include "general/commandprogram.h"
 
 namespace Ui {
 class CommandsRunDialog;
 }
 
-class CommandExecuter : public QObject {
-    Q_OBJECT
-
-public:
-    CommandExecuter(const QVector<BurnInCommand*>& commands, const SystemControllerClass* controller, QWidget *parent = 0);
-    bool isPaused() const;
-    bool isRunning() const;
-    
-public slots:
-    void start();
-    void togglePause();
-    void abort();
-    
-signals:
-    void commandStarted(int n, QDateTime dt);
-    void commandFinished(int n, QDateTime dt);
-    void commandStatusUpdate(int n, QString status);
-    void allFinished();
-
-private:
-    QVector<BurnInCommand*> _commands;
-    const SystemControllerClass* _controller;
-    
-    std::atomic<bool> _shouldAbort;
-    std::atomic<bool> _shouldPause;
-    std::atomic<bool> _isRunning;
-    
-    class CommandExecuteHandler : public AbstractCommandHandler {
-    public:
-        CommandExecuteHandler(CommandExecuter* executer, int n, const SystemControllerClass* controller);
-        
-        void handleCommand(BurnInWaitCommand& command) override;
-        void handleCommand(BurnInVoltageSourceOutputCommand& command) override;
-        void handleCommand(BurnInVoltageSourceSetCommand& command) override;
-        void handleCommand(BurnInChillerOutputCommand& command) override;
-        void handleCommand(BurnInChillerSetCommand& command) override;
-        void handleCommand(BurnInDAQCommand& command) override;
-        
-        bool error;
-        
-        const double VOLTAGESRC_EPSILON = 0.1; // V, for comparing two voltage values
-        const double CHILLER_TEMP_EPSILON = 0.1; // °C, for comparing two temperature values
-        const unsigned int WAIT_INTERVAL = 1; // s
-        
-    private:
-        CommandExecuter* _executer;
-        int _n;
-        const SystemControllerClass* _controller;
-        
-        void _waitForVoltage(PowerControlClass* source, int output);
-        void _waitForChiller(Chiller* chiller);
-    };
-    
-};
-
 class CommandsRunDialog : public QDialog
 {
     Q_OBJECT
 
 public:
-    explicit CommandsRunDialog(const QVector<BurnInCommand*>& commands, const SystemControllerClass* controller, QWidget *parent = 0);
+    /**
+     * @param commands Displayed in the list
+     * @param program The commands compiled, which is run
+     */
+    explicit CommandsRunDialog(const QVector<BurnInCommand*>& commands, const CommandProgram& program, const SystemControllerClass* controller, QWidget *parent = 0);
     ~CommandsRunDialog();
     
     void reject();
@@ -88,6 +43,7 @@ private slots:
     void onCommandFinished(int n, QDateTime dt);
     void onCommandStatusUpdate(int n, QString status);
     void onAllFinished();
+    void onDisplayTimer();
 
 private:
     Ui::CommandsRunDialog *ui;
@@ -96,9 +52,25 @@ private:
     CommandExecuter _executer;
     QThread _executer_thread;
     
+    // Device status labels. Changes only mark a label, the timer
+    // updates the marked ones.
+    struct StatusDisplay {
+        QLabel* label;
+        std::function<QString()> text;
+        bool changed;
+    };
+    struct ChillerState {
+        bool on;
+        float temperature;
+    };
+    std::vector<StatusDisplay> _displays;
+    std::map<const Chiller*, ChillerState> _chillerStates;
+    QTimer _displayTimer;
+    
     void _setupDisplays(const SystemControllerClass* controller);
-    void _updateDisplayLabel(QLabel* label, std::string name, PowerControlClass* source);
-    void _updateDisplayLabel(QLabel* label, std::string name, Chiller* chiller);
+    void _addDisplay(std::function<QString()> text);
+    QString _displayText(std::string name, PowerControlClass* source) const;
+    QString _displayText(std::string name, const Chiller* chiller) const;
     void _logMessage(QString message);
 };
 
@@ -0,0 +1,86 @@
+#include "diagnosticspage.h"
+
+#include <QEvent>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+const int DIAGNOSTICS_REFRESH_INTERVAL = 1000; // ms
+
+namespace {
+
+QString formatTime(qint64 us) {
+    if (us < 10000)
+        return QString::number(us) + " µs";
+    return QString::number(us / 1000) + " ms";
+}
+
+}
+
+DiagnosticsPage::DiagnosticsPage(QWidget* diagnosticsWidget, QObject* parent)
+    : QObject(parent)
+{
+    _diagnosticsWidget = diagnosticsWidget;
+    _controller = nullptr;
+
+    _table = new QTableWidget(0, 9, _diagnosticsWidget);
+    _table->setHorizontalHeaderLabels({"Device", "Sent", "Received", "Queries",
+        "Mean round trip", "Max round trip", "Timeouts", "Lock waits", "Max lock wait"});
+    _table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _table->verticalHeader()->hide();
+    _table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    QVBoxLayout* layout = new QVBoxLayout(_diagnosticsWidget);
+    layout->addWidget(_table);
+
+    // Only refresh while somebody looks at the page
+    _diagnosticsWidget->installEventFilter(this);
+    connect(&_timer, &QTimer::timeout, this, &DiagnosticsPage::_refresh);
+}
+
+void DiagnosticsPage::setSystemController(const SystemControllerClass* controller) {
+    _controller = controller;
+    _refresh();
+}
+
+bool DiagnosticsPage::eventFilter(QObject* watched, QEvent* event) {
+    if (watched == _diagnosticsWidget) {
+        if (event->type() == QEvent::Show) {
+            _refresh();
+            _timer.start(DIAGNOSTICS_REFRESH_INTERVAL);
+        } else if (event->type() == QEvent::Hide)
+            _timer.stop();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void DiagnosticsPage::_refresh() {
+    if (_controller == nullptr) {
+        _table->setRowCount(0);
+        return;
+    }
+
+    std::vector<GenericInstrumentClass*> devices = _controller->getDevices();
+    _table->setRowCount(static_cast<int>(devices.size()));
+    for (size_t i = 0; i < devices.size(); ++i) {
+        CommunicationStats stats = devices[i]->getStats();
+        qint64 meanRoundTrip = stats.queries > 0 ? stats.roundTripTotal / static_cast<qint64>(stats.queries) : 0;
+        QStringList cells = {
+            QString::fromStdString(_controller->getId(devices[i])),
+            QString::number(stats.bytesSent) + " B",
+            QString::number(stats.bytesReceived) + " B",
+            QString::number(stats.queries),
+            formatTime(meanRoundTrip),
+            formatTime(stats.roundTripMax),
+            QString::number(stats.timeouts),
+            QString::number(stats.lockContentions) + " (" + formatTime(stats.lockWaitTotal) + ")",
+            formatTime(stats.lockWaitMax)
+        };
+        for (int col = 0; col < cells.size(); ++col) {
+            QTableWidgetItem* item = _table->item(static_cast<int>(i), col);
+            if (item == nullptr) {
+                item = new QTableWidgetItem();
+                _table->setItem(static_cast<int>(i), col, item);
+            }
+            item->setText(cells[col]);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef DIAGNOSTICSPAGE_H
+#define DIAGNOSTICSPAGE_H
+
+#include <QObject>
+#include <QTableWidget>
+#include <QTimer>
+#include <QWidget>
+
+#include "general/systemcontrollerclass.h"
+
+/**
+ * Shows the communication counters of every device in a table, so that
+ * slow connections and contention on them can be spotted. The table is
+ * refreshed once per second while the page is visible.
+ */
+class DiagnosticsPage : public QObject
+{
+    Q_OBJECT
+
+public:
+    DiagnosticsPage(QWidget* diagnosticsWidget, QObject* parent = nullptr);
+
+    /**
+     * @param controller The controller of the devices to show. nullptr
+     *     to clear the table
+     */
+    void setSystemController(const SystemControllerClass* controller);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    void _refresh();
+
+private:
+    QWidget* _diagnosticsWidget;
+    QTableWidget* _table;
+    QTimer _timer;
+    const SystemControllerClass* _controller;
+};
+
+#endif // DIAGNOSTICSPAGE_H
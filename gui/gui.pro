@@ -0,0 +1,62 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2018-07-25T11:10:00
+#
+#-------------------------------------------------
+
+QT       += core gui widgets
+QT       += network
+
+TARGET = burnin
+TEMPLATE = app
+
+# Next to burnin-cli in the top build directory
+DESTDIR = $$OUT_PWD/..
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which has been marked as deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can also make your code fail to compile if you use deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+CONFIG += c++11
+QMAKE_CXXFLAGS += -Werror=switch
+
+OBJECTS_DIR = obj
+MOC_DIR = obj
+UI_HEADERS_DIR = obj
+UI_SOURCES_DIR = obj
+UI_DIR = obj
+
+include(../core.pri)
+
+SOURCES += \
+    main.cpp \
+    mainwindow.cpp \
+    daqpage.cpp \
+    commandlistpage.cpp \
+    commandmodifydialog.cpp \
+    commandsrundialog.cpp \
+    commanddisplayer.cpp \
+    readingscache.cpp \
+    diagnosticspage.cpp
+
+FORMS += \
+    mainwindow.ui \
+    commandmodifydialog.ui \
+    commandsrundialog.ui
+
+HEADERS += \
+    mainwindow.h \
+    daqpage.h \
+    commandlistpage.h \
+    commandmodifydialog.h \
+    commandsrundialog.h \
+    commanddisplayer.h \
+    readingscache.h \
+    diagnosticspage.h
@@ -1,5 +1,8 @@
 #include "general/logger.h"
 #include "gui/mainwindow.h"
+#include "devices/environment/thermorasp.h"
+#include "general/datarecorder.h"
+#include "general/BurnInException.h"
 #include <QApplication>
 extern "C" {
 	#include "lxi.h"
@@ -16,8 +19,23 @@ int main(int argc, char *argv[]) {
     //replaces commas with dots in printf
     setlocale(LC_ALL,"");
     setlocale(LC_NUMERIC,"");
-    qRegisterMetaType<QMap<QString, QString>>("QMap<QString, QString>");
+    qRegisterMetaType<ThermoraspReadings>("ThermoraspReadings");
     qRegisterMetaType<QtMsgType>("QtMsgType");
+    
+    if (argc > 1 and std::string(argv[1]) == "--export-csv") {
+        if (argc != 4) {
+            std::cerr << "Usage: " << argv[0] << " --export-csv <recording directory> <csv file>" << std::endl;
+            return 1;
+        }
+        try {
+            DataRecorder::exportCsv(argv[2], argv[3]);
+        } catch (const BurnInException& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
     lxi_init();
 
     qInstallMessageHandler(messageHandler);
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <typeinfo>
+#include <algorithm>
 
 #include <QFileDialog>
 #include <QMessageBox>
@@ -70,11 +71,17 @@ VoltageSourceWidget::VoltageSourceWidget(const QString& title, PowerControlClass
             this->onOnOffToggled(i + 1, state);
         });
         if (settersAlwaysEnabled) {
+            // The setters run on the thread of the device, the window
+            // doesn't wait for them
             connect(control.v_set, static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), this, [device, i](double voltage) {
-                device->setVolt(voltage, i + 1);
+                device->getContext()->post([device, i, voltage]() {
+                    device->setVolt(voltage, i + 1);
+                });
             });
             connect(control.i_set, static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), this, [device, i](double current) {
-               device->setCurr(current, i + 1);
+                device->getContext()->post([device, i, current]() {
+                    device->setCurr(current, i + 1);
+                });
             });
         }
     }
@@ -83,16 +90,23 @@ VoltageSourceWidget::VoltageSourceWidget(const QString& title, PowerControlClass
 }
 
 void VoltageSourceWidget::onOnOffToggled(int output, bool state) {
+    PowerControlClass* device = _device;
     if (state) {
-        _device->setVolt(_controls[output - 1].v_set->value(), output);
-        _device->setCurr(_controls[output - 1].i_set->value(), output);
-        _device->onPower(output);
+        double voltage = _controls[output - 1].v_set->value();
+        double current = _controls[output - 1].i_set->value();
+        device->getContext()->post([device, output, voltage, current]() {
+            device->setVolt(voltage, output);
+            device->setCurr(current, output);
+            device->onPower(output);
+        });
     } else {
-        _device->offPower(output);
+        device->getContext()->post([device, output]() {
+            device->offPower(output);
+        });
     }
 }
 
-void VoltageSourceWidget::initialize() {
+void VoltageSourceWidget::initialize(ReadingsCache* cache, const SystemControllerClass* controller) {
     connect(_device, &PowerControlClass::voltSetChanged, this, [this](double volt, int output) {
         QDoubleSpinBox* box = this->_controls[output - 1].v_set;
         QSignalBlocker blocker(box);
@@ -103,23 +117,25 @@ void VoltageSourceWidget::initialize() {
         QSignalBlocker blocker(box);
         box->setValue(curr);
     });
-    connect(_device, &PowerControlClass::voltAppChanged, this, [this](double volt, int output) {
-        QLCDNumber* num = this->_controls[output - 1].v_applied;
-        QSignalBlocker blocker(num);
-        // If a small number needs too many digits, display() seems to do nothing.
-        if (abs(volt) < 0.0001)
-            num->display(0.);
-        else
-            num->display(volt);
-    });
-    connect(_device, &PowerControlClass::currAppChanged, this, [this](double curr, int output) {
-        QLCDNumber* num = this->_controls[output - 1].i_applied;
-        QSignalBlocker blocker(num);
-        if (abs(curr) < 0.0001)
-            num->display(0.);
-        else
-            num->display(curr);
-    });
+    for (int i = 0; i < static_cast<int>(_controls.size()); ++i) {
+        QLCDNumber* volt = _controls[i].v_applied;
+        cache->watch(controller->getChannelName(_device, "voltage", i + 1), [volt](double value) {
+            QSignalBlocker blocker(volt);
+            // If a small number needs too many digits, display() seems to do nothing.
+            if (abs(value) < 0.0001)
+                volt->display(0.);
+            else
+                volt->display(value);
+        });
+        QLCDNumber* curr = _controls[i].i_applied;
+        cache->watch(controller->getChannelName(_device, "current", i + 1), [curr](double value) {
+            QSignalBlocker blocker(curr);
+            if (abs(value) < 0.0001)
+                curr->display(0.);
+            else
+                curr->display(value);
+        });
+    }
     connect(_device, &PowerControlClass::powerStateChanged, this, [this](bool on, int output) {
         QCheckBox* box = this->_controls[output - 1].onoff_button;
         QSignalBlocker blocker(box);
@@ -152,14 +168,18 @@ ThermoraspWidget::ThermoraspWidget(const QString& title, Thermorasp* device)
     setLayout(layout);
 }
 
-void ThermoraspWidget::initialize() {
-    connect(_device, &Thermorasp::gotNewReadings, this, [this](const QMap<QString, QString>& readings) {
-        int i = 0;
-        for (const auto& name: this->_device->getSensorNames()) {
-            this->_values[i]->display(readings[QString::fromStdString(name)]);
-            ++i;
-        }
-    });
+void ThermoraspWidget::initialize(ReadingsCache* cache, const SystemControllerClass* controller) {
+    std::vector<std::string> names = _device->getSensorNames();
+    for (size_t i = 0; i < names.size() and i < _values.size(); ++i) {
+        QLCDNumber* value = _values[i];
+        cache->watch(controller->getChannelName(_device, names[i]), [value](double temperature) {
+            // Blank while the sensor doesn't answer
+            if (qIsNaN(temperature))
+                value->display(QString());
+            else
+                value->display(temperature);
+        });
+    }
 }
 
 ChillerWidget::ChillerWidget(const QString& title, Chiller* device)
@@ -194,15 +214,22 @@ ChillerWidget::ChillerWidget(const QString& title, Chiller* device)
 
 void ChillerWidget::onOnOffToggled(bool state) {
     _workingTemp->setEnabled(not state);
+    Chiller* device = _device;
     if (state) {
-        _device->SetWorkingTemperature(_workingTemp->value());
-        _device->SetCirculatorOn();
-    } else{
-        _device->SetCirculatorOff();
+        float temperature = _workingTemp->value();
+        device->getContext()->post([device, temperature]() {
+            if (not device->SetWorkingTemperature(temperature) or not device->SetCirculatorOn())
+                qCritical("Could not turn on %s", device->getContext()->getName().c_str());
+        });
+    } else {
+        device->getContext()->post([device]() {
+            if (not device->SetCirculatorOff())
+                qCritical("Could not turn off %s", device->getContext()->getName().c_str());
+        });
     }
 }
 
-void ChillerWidget::initialize() {
+void ChillerWidget::initialize(ReadingsCache* cache, const SystemControllerClass* controller) {
     connect(_device, &Chiller::circulatorStatusChanged, this, [this](bool on) {
         QSignalBlocker blocker(this->_onoffButton);
         this->_onoffButton->setChecked(on);
@@ -212,9 +239,10 @@ void ChillerWidget::initialize() {
         QSignalBlocker blocker(this->_workingTemp);
         this->_workingTemp->setValue(temperature);
     });
-    connect(_device, &Chiller::bathTemperatureChanged, this, [this](float temperature) {
-        QSignalBlocker blocker(this->_bathTemp);
-        this->_bathTemp->display(temperature);
+    QLCDNumber* bathTemp = _bathTemp;
+    cache->watch(controller->getChannelName(_device, "bath_temperature"), [bathTemp](double temperature) {
+        QSignalBlocker blocker(bathTemp);
+        bathTemp->display(temperature);
     });
 }
 
@@ -247,7 +275,7 @@ PeltierWidget::PeltierWidget(const QString& title)
     setLayout(layout);
 }
 
-void PeltierWidget::initialize() {
+void PeltierWidget::initialize(ReadingsCache*, const SystemControllerClass*) {
     
 }
 
@@ -259,8 +287,12 @@ MainWindow::MainWindow(Logger *logger, QWidget *parent)
     ui->setupUi(this);
     commandListPage = new CommandListPage(ui->CommandList);
     daqPage = new DAQPage(ui->DAQControl);
+    QWidget* diagnosticsWidget = new QWidget();
+    ui->tabWidget->addTab(diagnosticsWidget, "Diagnostics");
+    diagnosticsPage = new DiagnosticsPage(diagnosticsWidget, this);
 
     fControl = nullptr;
+    _readingsCache = nullptr;
     
     ui->CommandList->setEnabled(false);
     
@@ -273,12 +305,33 @@ MainWindow::~MainWindow() {
 
 void MainWindow::initialize()
 {
-    // Connect devices to GUI widgets
+    // Connect devices to GUI widgets. Readings are shown ten times per
+    // second at most, independent of how often they arrive
+    _readingsCache = new ReadingsCache(fControl->getSampleHub(), this);
     for (auto& widget: _deviceWidgets)
-        widget->initialize();
+        widget->initialize(_readingsCache, fControl);
+    _readingsCache->start();
     
-    // Initialize the hardware devices
+    // Initialize the hardware devices. The widgets of the devices that
+    // failed stay disabled, the others can be used
     fControl->initialize();
+    std::vector<std::string> failed = fControl->getFailedDevices();
+    for (auto& widget: _deviceWidgets) {
+        QString title = widget->title();
+        if (std::find(failed.begin(), failed.end(), title.toStdString()) != failed.end()) {
+            widget->setEnabled(false);
+            widget->setTitle(title + " (not initialized)");
+            continue;
+        }
+        // Same while the connection to the device is lost
+        GenericInstrumentClass* device = fControl->getDeviceById(title.toStdString());
+        if (device == nullptr)
+            continue;
+        connect(device, &GenericInstrumentClass::connectionStateChanged, widget, [widget, title](bool connected) {
+            widget->setEnabled(connected);
+            widget->setTitle(connected ? title : title + " (connection lost)");
+        });
+    }
     
     // Setup thread to refresh the readings from the devices
     fControl->startRefreshingReadings();
@@ -357,6 +410,7 @@ bool MainWindow::readXmlFile()
     }
     
     commandListPage->setSystemController(fControl);
+    diagnosticsPage->setSystemController(fControl);
     if (fControl->getDaqModules().size() != 0)
         daqPage->setDAQModule(fControl->getDaqModules()[0]);
 
@@ -379,18 +433,24 @@ void MainWindow::on_read_conf_button_clicked()
         ui->CommandList->setEnabled(true);
         ui->read_conf_button->setEnabled(false);
         
-        if (fControl->getDaqModules().size() != 0)
+        if (fControl->getDaqModules().size() != 0 and not fControl->hasFailed(fControl->getDaqModules()[0]))
             ui->DAQControl->setEnabled(true);
             
     } catch (const BurnInException& e) {
         qCritical("%s", e.what());
         
         commandListPage->setSystemController(nullptr);
+        diagnosticsPage->setSystemController(nullptr);
         daqPage->setDAQModule(nullptr);
         
         QMessageBox dialog(this);
         dialog.critical(this, "Error", QString::fromStdString(e.what()));
         
+        // Takes its readings from the controller
+        if (_readingsCache != nullptr) {
+            delete _readingsCache;
+            _readingsCache = nullptr;
+        }
         if (fControl != nullptr) {
             delete fControl;
             fControl = nullptr;
@@ -429,12 +489,17 @@ void MainWindow::on_read_conf_button_clicked()
 void MainWindow::app_quit() {
     qDebug("Qutting");
     if (fControl != nullptr) {
+        // Waits for the operations queued before
         for (auto& chiller: fControl->getChillers()) {
-            chiller->SetWorkingTemperature(20);
-            chiller->SetCirculatorOff();
+            chiller->getContext()->call([chiller]() {
+                chiller->SetWorkingTemperature(20);
+                chiller->SetCirculatorOff();
+            });
         }
         for (auto& source: fControl->getVoltageSources()) {
-            source->offPower(0);
+            source->getContext()->call([source]() {
+                source->offPower(0);
+            });
             ControlKeithleyPower* keithley = dynamic_cast<ControlKeithleyPower*>(source);
             if (keithley)
                 keithley->waitForSafeShutdown();
@@ -14,6 +14,8 @@
 #include "devices/environment/chiller.h"
 #include "gui/commandlistpage.h"
 #include "gui/daqpage.h"
+#include "gui/diagnosticspage.h"
+#include "gui/readingscache.h"
 
 namespace Ui {
     class MainWindow;
@@ -25,7 +27,12 @@ class DeviceWidget : public QGroupBox {
     Q_OBJECT
 public:
     DeviceWidget(const QString& title);
-    virtual void initialize() = 0;
+    
+    /**
+     * Connect the widget to its device. Readings are taken from the
+     * cache, changes made by the user from the device's signals.
+     */
+    virtual void initialize(ReadingsCache* cache, const SystemControllerClass* controller) = 0;
 };
 
 
@@ -46,7 +53,7 @@ class VoltageSourceWidget : public DeviceWidget {
 
 public:
     VoltageSourceWidget(const QString& title, PowerControlClass* device, bool settersAlwaysEnabled);
-    void initialize();
+    void initialize(ReadingsCache* cache, const SystemControllerClass* controller);
     
 private slots:
     void onOnOffToggled(int output, bool state);
@@ -63,7 +70,7 @@ class ThermoraspWidget : public DeviceWidget {
 
 public:
     ThermoraspWidget(const QString& title, Thermorasp* device);
-    void initialize();
+    void initialize(ReadingsCache* cache, const SystemControllerClass* controller);
     
 private:
     Thermorasp* _device;
@@ -76,7 +83,7 @@ class ChillerWidget : public DeviceWidget {
     
 public:
     ChillerWidget(const QString& title, Chiller* device);
-    void initialize();
+    void initialize(ReadingsCache* cache, const SystemControllerClass* controller);
     
 private slots:
     void onOnOffToggled(bool state);
@@ -94,7 +101,7 @@ class PeltierWidget : public DeviceWidget {
     
 public:
     PeltierWidget(const QString& title);
-    void initialize();
+    void initialize(ReadingsCache* cache, const SystemControllerClass* controller);
     
 private:
     QDoubleSpinBox* _workingTemp;
@@ -134,8 +141,10 @@ private:
     std::vector<ChillerWidget*> _chillerWidgets;
 
     SystemControllerClass *fControl;
+    ReadingsCache* _readingsCache;
     CommandListPage* commandListPage;
     DAQPage* daqPage;
+    DiagnosticsPage* diagnosticsPage;
 
 };
 
@@ -0,0 +1,56 @@
+#include "readingscache.h"
+
+const int READINGS_UPDATE_INTERVAL = 100; // ms
+const size_t READINGS_BATCH_SIZE = 1024; // Samples taken from the hub at once
+
+ReadingsCache::ReadingsCache(SampleHub* hub, QObject* parent)
+    : QObject(parent)
+{
+    _hub = hub;
+    _consumer = hub->addConsumer();
+    _channelNames = hub->getChannelNames();
+    _values.resize(_channelNames.size(), 0);
+    _changed.resize(_channelNames.size(), false);
+    _watchers.resize(_channelNames.size());
+    _samples.resize(READINGS_BATCH_SIZE);
+
+    connect(&_timer, &QTimer::timeout, this, &ReadingsCache::_update);
+}
+
+bool ReadingsCache::watch(const std::string& channel, std::function<void(double)> update) {
+    for (size_t i = 0; i < _channelNames.size(); ++i) {
+        if (_channelNames[i] == channel) {
+            _watchers[i].push_back(update);
+            return true;
+        }
+    }
+    qWarning("No channel %s to display", channel.c_str());
+    return false;
+}
+
+void ReadingsCache::start() {
+    _timer.start(READINGS_UPDATE_INTERVAL);
+}
+
+void ReadingsCache::_update() {
+    // Only the latest value of a channel is of interest
+    size_t count;
+    while ((count = _hub->drain(_consumer, _samples.data(), _samples.size())) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            quint32 channel = _samples[i].channel;
+            // Held back by the change filter of the device
+            if (channel >= _values.size() or not _samples[i].changed)
+                continue;
+            _values[channel] = _samples[i].value;
+            _changed[channel] = true;
+        }
+    }
+
+    for (size_t channel = 0; channel < _values.size(); ++channel) {
+        if (not _changed[channel])
+            continue;
+        _changed[channel] = false;
+        for (const auto& update: _watchers[channel])
+            update(_values[channel]);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef READINGSCACHE_H
+#define READINGSCACHE_H
+
+#include <QObject>
+#include <QTimer>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "general/samplehub.h"
+
+/**
+ * Keeps the latest value of every channel of a SampleHub for the GUI.
+ * Ten times per second it takes the new samples from the hub and calls
+ * the update functions of the channels that got new values. Widgets
+ * are therefore updated at a fixed rate, no matter how often the
+ * devices are read.
+ */
+class ReadingsCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Registers as a consumer of the hub. Samples published from now on
+     * are kept until the next update.
+     * @param hub The hub. Must outlive the cache
+     */
+    ReadingsCache(SampleHub* hub, QObject* parent = nullptr);
+
+    /**
+     * Call a function with the latest value whenever a channel got new
+     * samples. It gets called on the thread of the cache.
+     * @param channel Name of the channel
+     * @param update The function
+     * @return false if the hub has no channel with this name
+     */
+    bool watch(const std::string& channel, std::function<void(double)> update);
+
+    /**
+     * Start updating
+     */
+    void start();
+
+private slots:
+    void _update();
+
+private:
+    SampleHub* _hub;
+    int _consumer;
+    std::vector<std::string> _channelNames;
+    std::vector<double> _values;
+    std::vector<bool> _changed;
+    std::vector<std::vector<std::function<void(double)>>> _watchers;
+    std::vector<Sample> _samples;
+    QTimer _timer;
+};
+
+#endif // READINGSCACHE_H